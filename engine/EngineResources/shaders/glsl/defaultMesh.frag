@@ -1,38 +1,51 @@
 
+// Light list offsets and indices can be larger than mediump ints
+precision highp int;
+
 out vec4 FragColor;
 
 
 in vec3 WorldFragPos;
-in vec4 WorldFragPosLightSpace;
 in vec3 WorldCameraPos;
-in vec3 TangentFragPos;
-in vec3 TangentLightPos[4];
-in vec3 TangentCameraPos;
+in float ViewDepth;
 in vec2 TexCoords;
 in vec3 localNormal;
 
 in mat3 TBN;
 
 uniform sampler2D shadowMap;
-uniform samplerCube shadowMapPoint;
+uniform sampler2D shadowMapPoint;
 uniform samplerCube skyboxTexture;
 
+// Point lights and the lists of lights in each cluster, see jle3DRenderer::buildLightClusters()
+uniform highp sampler2D ClusterLightsTexture;
+uniform highp usampler2D ClusterGridTexture;
+uniform highp usampler2D ClusterIndicesTexture;
+
 uniform bool useAlbedoTexture;
 uniform sampler2D albedoTexture;
 
 uniform bool useNormalTexture;
 uniform sampler2D normalTexture;
 
-uniform float farPlane;
-
-uniform int LightsCount;
-uniform vec3 LightPositions[4];
-uniform vec3 LightColors[4];
-
-uniform bool UseDirectionalLight;
-uniform bool UseEnvironmentMapping;
-uniform vec3 DirectionalLightColour;
-uniform vec3 DirectionalLightDir;
+// Matches jle3DRenderer::jle3DRendererLightsBlock
+layout (std140) uniform LightsBlock
+{
+    vec4 DirectionalLightColour;
+    vec4 DirectionalLightDir;
+    vec4 ClusterScale;
+    highp ivec4 ClusterDimensions;
+    highp int UseDirectionalLight;
+    highp int UseEnvironmentMapping;
+};
+
+// Matches jle3DRenderer::jle3DRendererShadowsBlock
+layout (std140) uniform ShadowsBlock
+{
+    mat4 CascadeMatrices[4];
+    vec4 CascadeSplits;
+    vec4 PointShadowFace;
+};
 
 const float pi = 3.141592653589;
 const vec3 albedo = vec3(0.83, 0.68, 0.22);
@@ -238,27 +251,72 @@ float SampleShadowMapLinear(sampler2D shadowMap, vec2 coords, float compare, vec
 }
 
 
-float ShadowCalculationPoint(vec3 fragPos, vec3 lightPos)
+// Each shadowed light has a row of cube faces in the atlas, ordered and rendered like the faces
+// of a cube map, see jle3DRenderer::renderPointLights()
+float ShadowCalculationPoint(vec3 fragPos, vec3 lightPos, float radius, int slot)
 {
     vec3 worldPosToLight = fragPos - lightPos;
+    vec3 absolute = abs(worldPosToLight);
 
-    // Sample from the cube shadow texture
-    float closestDepth = texture(shadowMapPoint, worldPosToLight).r;
+    // Pick the face and its coordinates the way a cube map lookup does
+    int face;
+    float major;
+    vec2 faceCoords;
+    if (absolute.x >= absolute.y && absolute.x >= absolute.z)
+    {
+        face = worldPosToLight.x > 0.0 ? 0 : 1;
+        major = absolute.x;
+        faceCoords = vec2(worldPosToLight.x > 0.0 ? -worldPosToLight.z : worldPosToLight.z, -worldPosToLight.y);
+    }
+    else if (absolute.y >= absolute.z)
+    {
+        face = worldPosToLight.y > 0.0 ? 2 : 3;
+        major = absolute.y;
+        faceCoords = vec2(worldPosToLight.x, worldPosToLight.y > 0.0 ? worldPosToLight.z : -worldPosToLight.z);
+    }
+    else
+    {
+        face = worldPosToLight.z > 0.0 ? 4 : 5;
+        major = absolute.z;
+        faceCoords = vec2(worldPosToLight.z > 0.0 ? worldPosToLight.x : -worldPosToLight.x, -worldPosToLight.y);
+    }
+
+    // Kept half a texel inside the face, so that filtering doesn't read the neighbouring faces
+    faceCoords = clamp(faceCoords / major * 0.5 + 0.5, PointShadowFace.zw, 1.0 - PointShadowFace.zw);
+    vec2 atlasCoords = (vec2(float(face), float(slot)) + faceCoords) * PointShadowFace.xy;
 
-    // Re-map from 0 to 1 back to 0 to far plane linearly
-    closestDepth *= farPlane;
+    // Re-map from 0 to 1 back to 0 to the light's radius linearly
+    float closestDepth = texture(shadowMapPoint, atlasCoords).r * radius;
 
     // The current depth from the light source
     float currentDepth = length(worldPosToLight);
 
-    float bias = 2.5;
+    float bias = 0.005 * radius;
     float shadow = currentDepth - bias > closestDepth ? 0.0 : 1.0;
 
     return shadow;
 }
 
-float ShadowCalculation(vec4 fragPosLightSpace, vec3 N, vec3 L)
+// The cascades are laid out 2x2 in the shadow map, the first in the bottom left
+float ShadowCalculation(vec3 fragPos, vec3 N, vec3 L)
 {
+    int cascade = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (ViewDepth > CascadeSplits[i])
+        {
+            cascade = i + 1;
+        }
+    }
+
+    if (cascade > 3)
+    {
+        // Beyond the shadow distance
+        return 1.0;
+    }
+
+    vec4 fragPosLightSpace = CascadeMatrices[cascade] * vec4(fragPos, 1.0);
+
     // Perspective division
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
 
@@ -271,19 +329,22 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 N, vec3 L)
         return 1.0;
     }
 
-    // Get closest depth value from light's perspective
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
-
     // The current depth from the light source from the lights perspective
     float currentDepth = projCoords.z;
 
     // Slightly add bias for mitigating shadow acne further
-    float bias = max(0.001 * (1.0 - dot(N, -L)), 0.00015);
+    float bias = max(0.001 * (1.0 - dot(N, L)), 0.00015);
 
     ivec2 textureSize2d = textureSize(shadowMap, 0);
     float sizeTexture = float(textureSize2d.x);
     float texelSize = 1.0 / sizeTexture;
 
+    // Samples are kept inside the cascade's quarter, so that the blur doesn't read the other cascades
+    vec2 cascadeOffset = vec2(float(cascade % 2), float(cascade / 2)) * 0.5;
+    vec2 atlasCoords = cascadeOffset + projCoords.xy * 0.5;
+    vec2 atlasMin = cascadeOffset + vec2(texelSize);
+    vec2 atlasMax = cascadeOffset + vec2(0.5 - 2.0 * texelSize);
+
     float shadow = 0.0;
     // Blur the shadows by sampling close by coordinates in the shadow map
     const int halfkernelWidth = 2;
@@ -291,7 +352,8 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 N, vec3 L)
     {
         for (int y = -halfkernelWidth; y <= halfkernelWidth; ++y)
         {
-            shadow += SampleShadowMapLinear(shadowMap, projCoords.xy + vec2(x, y) * texelSize, currentDepth - bias, vec2(texelSize));
+            vec2 coords = clamp(atlasCoords + vec2(x, y) * texelSize, atlasMin, atlasMax);
+            shadow += SampleShadowMapLinear(shadowMap, coords, currentDepth - bias, vec2(texelSize));
         }
     }
     shadow /= ((float(halfkernelWidth)*2.0+1.0)*(float(halfkernelWidth)*2.0+1.0));
@@ -307,6 +369,28 @@ float CalculateAttenuation(float distance, float constant, float linear, float q
     return distance / (constant + linear * distance + quadratic * (distance*distance));
 }
 
+// Fades the light out smoothly to zero at its radius
+float RadiusFalloff(float distance, float radius)
+{
+    float x = distance / radius;
+    float falloff = clamp(1.0 - x*x*x*x, 0.0, 1.0);
+    return falloff * falloff;
+}
+
+ivec2 ClusterTexel(int index, int width)
+{
+    return ivec2(index % width, index / width);
+}
+
+// Offset and count of the light list of the cluster this fragment is in
+uvec2 FragmentCluster()
+{
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy * ClusterScale.xy), ivec2(0), ClusterDimensions.xy - 1);
+    float clusterDepth = ClusterDimensions.w != 0 ? log(max(ViewDepth, 0.0001)) : ViewDepth;
+    int slice = clamp(int(floor(clusterDepth * ClusterScale.z + ClusterScale.w)), 0, ClusterDimensions.z - 1);
+    return texelFetch(ClusterGridTexture, ivec2(tile.y * ClusterDimensions.x + tile.x, slice), 0).rg;
+}
+
 void main()
 {
 
@@ -319,46 +403,61 @@ void main()
     {
         N = vec3(0.0, 0.0, 1.0);
     }
-    vec3 V = normalize(TangentCameraPos - TangentFragPos);
+    vec3 worldView = normalize(WorldCameraPos - WorldFragPos);
+    vec3 worldSpaceNormal = transpose(TBN) * N;
 
     vec3 LightOutTotal = vec3(0.0);
-    for (int l = 0; l < LightsCount; ++l)
+
+    // Only the lights whose radius reaches this fragment's cluster
+    uvec2 cluster = FragmentCluster();
+    int lightsWidth = textureSize(ClusterLightsTexture, 0).x;
+    int indicesWidth = textureSize(ClusterIndicesTexture, 0).x;
+    for (uint i = 0u; i < cluster.y; ++i)
     {
-        vec3 L = normalize(TangentLightPos[l] - TangentFragPos);
+        int l = int(texelFetch(ClusterIndicesTexture, ClusterTexel(int(cluster.x + i), indicesWidth), 0).r);
+        vec4 lightPositionRadius = texelFetch(ClusterLightsTexture, ClusterTexel(l * 2, lightsWidth), 0);
+        vec4 lightColorSlot = texelFetch(ClusterLightsTexture, ClusterTexel(l * 2 + 1, lightsWidth), 0);
+        vec3 lightColor = lightColorSlot.rgb;
+        int shadowSlot = int(lightColorSlot.w);
+
+        vec3 L = normalize(lightPositionRadius.xyz - WorldFragPos);
 
         // Incident angle
-        float NdotL = max(dot(N, L), 0.0);
+        float NdotL = max(dot(worldSpaceNormal, L), 0.0);
 
         // Incoming radiance from the light source
-        float distance = length(TangentLightPos[l] - TangentFragPos);
-        float attenuation = CalculateAttenuation(distance, 1.0, 0.35, 0.44);
-        vec3 radiance = LightColors[l] * attenuation * ShadowCalculationPoint(WorldFragPos, LightPositions[l]);
+        float distance = length(lightPositionRadius.xyz - WorldFragPos);
+        float attenuation = CalculateAttenuation(distance, 1.0, 0.35, 0.44) * RadiusFalloff(distance, lightPositionRadius.w);
+        vec3 radiance = lightColor * attenuation;
 
-        //LightOutTotal += radiance * blinn_phong_brdf(L, V, N) * NdotL;
-         LightOutTotal += radiance * lambertian_brdf(L, V, N) * NdotL;
-        // LightOutTotal += radiance * cook_torrance_brdf(L, V, N) * NdotL;
-        // LightOutTotal += radiance * albedo * oren_nayar_brdf(L, V, N) * NdotL;
+        // Lights without a slot in the shadow atlas have a negative slot
+        if (shadowSlot >= 0)
+        {
+            radiance *= ShadowCalculationPoint(WorldFragPos, lightPositionRadius.xyz, lightPositionRadius.w, shadowSlot);
+        }
 
-    }
+        //LightOutTotal += radiance * blinn_phong_brdf(L, worldView, worldSpaceNormal) * NdotL;
+         LightOutTotal += radiance * lambertian_brdf(L, worldView, worldSpaceNormal) * NdotL;
+        // LightOutTotal += radiance * cook_torrance_brdf(L, worldView, worldSpaceNormal) * NdotL;
+        // LightOutTotal += radiance * albedo * oren_nayar_brdf(L, worldView, worldSpaceNormal) * NdotL;
 
-    vec3 worldView = normalize(WorldCameraPos - WorldFragPos);
-    vec3 worldSpaceNormal = transpose(TBN) * N;
+    }
 
-    if (UseDirectionalLight)
+    if (UseDirectionalLight != 0)
     {
-        vec3 L = normalize(DirectionalLightDir);
+        vec3 L = normalize(DirectionalLightDir.xyz);
 
         // Incident angle
         float NdotL = max(dot(worldSpaceNormal, L), 0.0);
 
         // Incoming radiance, depends on shadows from other objects
-        vec3 radiance = DirectionalLightColour;// * ShadowCalculation(WorldFragPosLightSpace, N, L);
+        vec3 radiance = DirectionalLightColour.rgb * ShadowCalculation(WorldFragPos, worldSpaceNormal, L);
 
         LightOutTotal += radiance * lambertian_brdf(L, worldView, worldSpaceNormal) * NdotL;
 
     }
 
-    if(UseEnvironmentMapping)
+    if (UseEnvironmentMapping != 0)
     {
         vec3 R = reflect(-worldView,normalize(worldSpaceNormal));
         vec3 environmentColor = texture(skyboxTexture, R).xyz;
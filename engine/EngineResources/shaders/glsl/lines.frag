@@ -1,7 +1,14 @@
 
 out vec4 OutColor;
 
-uniform vec3 cameraPos;
+// Matches jle3DRenderer::jle3DRendererCameraBlock
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 proj;
+    mat4 projView;
+    vec4 CameraPosition;
+};
 
 in vec3 pos;
 in vec3 color;
@@ -14,7 +21,7 @@ float CalculateAttenuation(float distance, float constant, float linear, float q
 
 void main(){
 
-    float distance = length(pos - cameraPos);
+    float distance = length(pos - CameraPosition.xyz);
     float attenuationDistance = distance / 25.0;
     float attenuation = CalculateAttenuation(attenuationDistance, attenuation.x, attenuation.y, attenuation.z);
 
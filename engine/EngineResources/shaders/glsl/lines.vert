@@ -3,7 +3,14 @@ layout (location = 0) in vec3 aPosWorldSpace;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec3 aAttenuation;
 
-uniform mat4 projView;
+// Matches jle3DRenderer::jle3DRendererCameraBlock
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 proj;
+    mat4 projView;
+    vec4 CameraPosition;
+};
 
 out vec3 pos;
 out vec3 color;
@@ -1,7 +1,7 @@
 
 out vec4 OutColor;
 
-uniform vec4 PickingColor;
+flat in vec4 PickingColor;
 
 void main(){
     OutColor = PickingColor;
@@ -1,10 +1,21 @@
 
 layout (location = 0) in vec3 aPos;
+layout (location = 5) in mat4 model;
+layout (location = 9) in vec4 aPickingColor;
 
-uniform mat4 model;
-uniform mat4 projView;
+flat out vec4 PickingColor;
+
+// Matches jle3DRenderer::jle3DRendererCameraBlock
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 proj;
+    mat4 projView;
+    vec4 CameraPosition;
+};
 
 void main()
 {
+    PickingColor = aPickingColor;
     gl_Position = projView * model * vec4(aPos, 1.0f);
 }
\ No newline at end of file
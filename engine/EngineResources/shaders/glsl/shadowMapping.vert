@@ -1,11 +1,19 @@
 
 layout (location = 0) in vec3 aPos;
+layout (location = 5) in mat4 model;
 
-uniform mat4 lightSpaceMatrix;
-uniform mat4 model;
+// Matches jle3DRenderer::jle3DRendererShadowsBlock
+layout (std140) uniform ShadowsBlock
+{
+    mat4 CascadeMatrices[4];
+    vec4 CascadeSplits;
+    vec4 PointShadowFace;
+};
+
+uniform int shadowCascade;
 
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    gl_Position = CascadeMatrices[shadowCascade] * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -1,8 +1,8 @@
 
 layout (location = 0) in vec3 aPos;
+layout (location = 5) in mat4 model;
 
 uniform mat4 lightSpaceMatrix;
-uniform mat4 model;
 
 out vec3 WorldPos;
 
@@ -3,13 +3,20 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+// Matches jle3DRenderer::jle3DRendererCameraBlock
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 proj;
+    mat4 projView;
+    vec4 CameraPosition;
+};
 
 void main()
 {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    // Convert the view matrix to mat3 first to remove the translation
+    vec4 pos = proj * mat4(mat3(view)) * vec4(aPos, 1.0);
 
     // Set the z component to w, such that after perspective division
     // it will equal 1, and therefore the maximum depth value.
@@ -58,15 +58,17 @@ void cAseprite::update(float dt) {
         quad.textureY = frame.frame.y + _textureY;
         quad.depth = getTransform().getWorldPosition().z;
 
+#ifndef BUILD_HEADLESS
         if (quad.texture.get()) {
             gCore->quadRendering().sendTexturedQuad(quad);
         }
+#endif
     }
 }
 
 
 cAseprite::cAseprite(jleObject *owner, jleScene *scene)
-    : jleComponent(owner, scene) {}
+    : jleRenderComponent(owner, scene) {}
 
 void cAseprite::currentAseprite(unsigned int index) {
     if (index < _aseprites.size()) {
@@ -3,10 +3,10 @@
 #pragma once
 
 #include "jleAseprite.h"
-#include "jleComponent.h"
+#include "jleRenderComponent.h"
 #include "jleTransform.h"
 
-class cAseprite : public jleComponent
+class cAseprite : public jleRenderComponent
 {
     JLE_REGISTER_COMPONENT_TYPE(cAseprite)
 public:
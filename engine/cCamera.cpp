@@ -16,11 +16,14 @@ cCamera::start()
         LOG_ERROR << "More than one camera detected!";
     }
 
+    // There is no window or framebuffer to follow, nor anything to project for
+#ifndef BUILD_HEADLESS
     _framebufferCallbackId = gEngine->addGameWindowResizeCallback([this](auto &&PH1, auto &&PH2) {
         framebufferResizeCallback(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2));
     });
 
     framebufferResizeCallback(gCore->window().width(), gCore->window().height());
+#endif
 }
 
 void
@@ -50,6 +53,7 @@ cCamera::framebufferResizeCallback(unsigned int width, unsigned int height)
 void
 cCamera::update(float dt)
 {
+#ifndef BUILD_HEADLESS
     auto &game = ((jleGameEngine *)gCore)->gameRef();
 
     if (_perspective) {
@@ -68,6 +72,7 @@ cCamera::update(float dt)
 
     auto &&transformation = _attachedToObject->getTransform().getWorldMatrix();
     game.mainCamera.setViewMatrix(glm::inverse(transformation), c.position);
+#endif
 }
 
 cCamera::cCamera(jleObject *owner, jleScene *scene) : jleComponent(owner, scene) {}
@@ -48,7 +48,7 @@ protected:
 
     bool _perspective{false};
 
-    int _framebufferCallbackId;
+    int _framebufferCallbackId{-1};
 
     inline static uint32_t sInstanceCounter = 0;
 };
@@ -11,7 +11,7 @@
 JLE_EXTERN_TEMPLATE_CEREAL_CPP(cLight)
 
 
-cLight::cLight(jleObject *owner, jleScene *scene) : jleComponent(owner, scene) {}
+cLight::cLight(jleObject *owner, jleScene *scene) : jleRenderComponent(owner, scene) {}
 void
 cLight::start()
 {
@@ -19,7 +19,9 @@ cLight::start()
 void
 cLight::update(float dt)
 {
-    gCore->rendering().rendering3d().sendLight(getTransform().getWorldPosition(), _color);
+#ifndef BUILD_HEADLESS
+    gCore->rendering().rendering3d().sendLight(getTransform().getWorldPosition(), _color, _radius);
+#endif
 }
 
 void
@@ -42,5 +44,5 @@ cLight::editorGizmosRender(bool selected)
 void
 cLight::registerLua(sol::state &lua, sol::table &table)
 {
-    lua.new_usertype<cLight>("cLight", sol::base_classes, sol::bases<jleComponent>(), "color", &cLight::_color);
+    lua.new_usertype<cLight>("cLight", sol::base_classes, sol::bases<jleComponent>(), "color", &cLight::_color, "radius", &cLight::_radius);
 }
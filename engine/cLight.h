@@ -2,11 +2,12 @@
 
 #pragma once
 
-#include "jleComponent.h"
+#include "jleRenderComponent.h"
+#include "jleSerializationFormat.h"
 
 #include <glm/vec3.hpp>
 
-class cLight : public jleComponent
+class cLight : public jleRenderComponent
 {
     JLE_REGISTER_COMPONENT_TYPE(cLight)
 public:
@@ -17,6 +18,9 @@ public:
     serialize(Archive &ar)
     {
         ar(CEREAL_NVP(_color));
+
+        // Not present in lights saved before clustered lighting
+        jleSerialization::optionalNvp(ar, "_radius", _radius);
     }
 
     void start() override;
@@ -31,6 +35,9 @@ public:
 
 protected:
     glm::vec3 _color{1.f};
+
+    // Distance at which the light fades out completely, lights only affect the clusters they reach
+    float _radius{100.f};
 };
 
 JLE_EXTERN_TEMPLATE_CEREAL_H(cLight)
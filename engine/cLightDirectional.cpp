@@ -13,10 +13,12 @@ JLE_EXTERN_TEMPLATE_CEREAL_CPP(cLightDirectional)
 void
 cLightDirectional::update(float dt)
 {
+#ifndef BUILD_HEADLESS
     gCore->rendering().rendering3d().enableDirectionalLight();
     auto mat4 = getTransform().getWorldMatrix();
 
     gCore->rendering().rendering3d().setDirectionalLight(mat4, _color);
+#endif
 }
 
 
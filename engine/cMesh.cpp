@@ -10,25 +10,76 @@ JLE_EXTERN_TEMPLATE_CEREAL_CPP(cMesh)
 
 cMesh::cMesh(jleObject *owner, jleScene *scene) : jleComponent(owner, scene) {}
 
+cMesh::~cMesh()
+{
+    // Scenes that are unloaded release their objects without destroying them first
+    removeProxy();
+}
+
 void
 cMesh::start()
-{}
+{
+    updateProxy();
+}
 
 void
-cMesh::update(float dt)
+cMesh::onDestroy()
 {
-    if (_meshRef) {
-        std::shared_ptr<jleMesh> mesh = _meshRef.get();
-        std::shared_ptr<jleMaterial> material = _materialRef.get();
-        gCore->rendering().rendering3d().sendMesh(
-            mesh, material, getTransform().getWorldMatrix(), _attachedToObject->instanceID(), true);
+    removeProxy();
+}
+
+void
+cMesh::onTransformChanged()
+{
+#ifndef BUILD_HEADLESS
+    if (_hasProxy) {
+        gCore->rendering().rendering3d().setMeshProxyTransform(this, getTransform().getWorldMatrix());
     }
+#endif
 }
 
 void
 cMesh::editorUpdate(float dt)
 {
-    update(dt);
+    // The mesh and material can be changed from the inspector while editing,
+    // moving the object is sent on by onTransformChanged()
+    const bool changed = _meshRef.get().get() != _proxyMesh || _materialRef.get().get() != _proxyMaterial;
+    if (changed || _hasProxy != static_cast<bool>(_meshRef)) {
+        updateProxy();
+    }
+}
+
+void
+cMesh::updateProxy()
+{
+#ifndef BUILD_HEADLESS
+    if (!_meshRef) {
+        removeProxy();
+        return;
+    }
+    gCore->rendering().rendering3d().setMeshProxy(this,
+                                                  _meshRef.get(),
+                                                  _materialRef.get(),
+                                                  getTransform().getWorldMatrix(),
+                                                  _attachedToObject->instanceID(),
+                                                  true);
+    _hasProxy = true;
+    _proxyMesh = _meshRef.get().get();
+    _proxyMaterial = _materialRef.get().get();
+#endif
+}
+
+void
+cMesh::removeProxy()
+{
+#ifndef BUILD_HEADLESS
+    if (_hasProxy) {
+        gCore->rendering().rendering3d().removeMeshProxy(this);
+        _hasProxy = false;
+        _proxyMesh = nullptr;
+        _proxyMaterial = nullptr;
+    }
+#endif
 }
 
 std::shared_ptr<jleMesh>
@@ -15,6 +15,8 @@ class cMesh : public jleComponent
 public:
     explicit cMesh(jleObject *owner = nullptr, jleScene *scene = nullptr);
 
+    ~cMesh() override;
+
     template <class Archive>
     void
     serialize(Archive &ar)
@@ -26,15 +28,43 @@ public:
 
     void start() override;
 
-    void update(float dt) override;
+    void onDestroy() override;
+
+    void onTransformChanged() override;
+
+    // The mesh is kept by the renderer as a proxy, which is only touched when the object moves
+    [[nodiscard]] float
+    tickInterval() const override
+    {
+        return -1.f;
+    }
 
     std::shared_ptr<jleMesh> getMesh();
 
+    [[nodiscard]] bool
+    resetForReuse() override
+    {
+        return resetToConstructed<cMesh>();
+    }
+
 protected:
 
     jleResourceRef<jleMesh> _meshRef;
     jleResourceRef<jleMaterial> _materialRef;
 
+private:
+    // Registers the proxy, or updates it with the current mesh, material and transform
+    void updateProxy();
+
+    void removeProxy();
+
+    // Copied along with the component, but the proxy is keyed on the component's address,
+    // so a copy that was never started doesn't touch the original's proxy
+    bool _hasProxy{false};
+
+    // What the proxy was last given, only compared against. The proxy keeps them alive.
+    const jleMesh *_proxyMesh{};
+    const jleMaterial *_proxyMaterial{};
 };
 
 JLE_EXTERN_TEMPLATE_CEREAL_H(cMesh)
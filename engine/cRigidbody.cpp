@@ -11,6 +11,9 @@
 
 #include "cMesh.h"
 #include "jleGameEngine.h"
+#include "jleResource.h"
+
+#include <plog/Log.h>
 
 JLE_EXTERN_TEMPLATE_CEREAL_CPP(cRigidbody)
 
@@ -25,6 +28,32 @@ cRigidbody::editorUpdate(float dt)
 void
 cRigidbody::start()
 {
+    auto meshComponent = _attachedToObject->findComponent<cMesh>();
+    if (!meshComponent) {
+        LOGE << "Rigidbody on " << _attachedToObject->_instanceName << " needs a cMesh on the same object";
+        return;
+    }
+
+    const auto mesh = meshComponent->getMesh();
+    if (!mesh) {
+        LOGE << "Rigidbody on " << _attachedToObject->_instanceName << " has no mesh to collide with";
+        return;
+    }
+
+    if (!gCore->resources().isLoaded(*mesh)) {
+        LOGE << "Rigidbody on " << _attachedToObject->_instanceName << " started before its mesh finished loading";
+        return;
+    }
+
+    if (mesh->positions().empty()) {
+        if (!gCore->settings().keepMeshVertexData) {
+            LOGE << "Rigidbody needs the mesh's vertices, which are not kept when keepMeshVertexData is off";
+        } else {
+            LOGE << "Rigidbody on " << _attachedToObject->_instanceName << " has a mesh without vertices";
+        }
+        return;
+    }
+
     if (_mass == 0) {
         generateCollisionStaticConcave();
     } else {
@@ -125,5 +154,7 @@ cRigidbody::generateCollisionStaticConcave()
 void
 cRigidbody::onDestroy()
 {
-    gEngine->physics().deleteRigidbody(body);
+    if (body) {
+        gEngine->physics().deleteRigidbody(body);
+    }
 }
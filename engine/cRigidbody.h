@@ -35,6 +35,12 @@ public:
 
     btRigidBody* getBody();
 
+    [[nodiscard]] bool
+    resetForReuse() override
+    {
+        return resetToConstructed<cRigidbody>();
+    }
+
 protected:
 
     friend class jlePhysics;
@@ -47,7 +53,7 @@ protected:
 
     glm::vec3 _size{1.f};
 
-    btRigidBody *body;
+    btRigidBody *body{};
 };
 
 JLE_EXTERN_TEMPLATE_CEREAL_H(cRigidbody)
@@ -20,3 +20,20 @@ void
 cSkybox::update(float dt)
 {
 }
+
+void
+cSkybox::applySkybox()
+{
+#ifndef BUILD_HEADLESS
+    auto skybox = _skybox.get();
+    if (!skybox) {
+        return;
+    }
+
+    if (gCore->resources().isMainThread()) {
+        gCore->rendering().rendering3d().setSkybox(skybox);
+    } else {
+        gCore->resources().runOnMainThread([skybox]() { gCore->rendering().rendering3d().setSkybox(skybox); });
+    }
+#endif
+}
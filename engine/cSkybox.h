@@ -17,18 +17,25 @@ public:
     serialize(Archive &ar)
     {
         ar(CEREAL_NVP(_skybox));
-
-        if(_skybox.get())
-        {
-            gCore->rendering().rendering3d().setSkybox(_skybox.get());
-        }
+        applySkybox();
     }
 
     void start() override;
 
     void update(float dt) override;
 
+    // The skybox is drawn by the pipeline, nothing to do per frame
+    [[nodiscard]] float
+    tickInterval() const override
+    {
+        return -1.f;
+    }
+
 protected:
+    // Hands the skybox to the renderer, on the main thread if deserialized by a scene loading
+    // on a background thread
+    void applySkybox();
+
     jleResourceRef<jleSkybox> _skybox;
 };
 
@@ -9,7 +9,7 @@
 #include "jleResource.h"
 
 cSprite::cSprite(jleObject *owner, jleScene *scene)
-    : jleComponent{owner, scene}, quad{nullptr} {}
+    : jleRenderComponent{owner, scene}, quad{nullptr} {}
 
 void cSprite::createAndSetTextureFromPath(const std::string &path) {
     quad.texture = gCore->resources().loadResourceFromFile<jleTexture>(jlePath{path});
@@ -40,7 +40,9 @@ void cSprite::update(float dt)
     quad.x = getTransform().getWorldPosition().x;
     quad.y = getTransform().getWorldPosition().y;
 
+#ifndef BUILD_HEADLESS
     if (quad.texture.get()) {
         gCore->quadRendering().sendTexturedQuad(*&quad);
     }
+#endif
 }
@@ -2,7 +2,7 @@
 
 #pragma once
 
-#include "jleComponent.h"
+#include "jleRenderComponent.h"
 #include "jleTransform.h"
 
 #include "jleQuads.h"
@@ -11,7 +11,7 @@
 #include <memory>
 #include <string>
 
-class cSprite : public jleComponent
+class cSprite : public jleRenderComponent
 {
     JLE_REGISTER_COMPONENT_TYPE(cSprite)
 public:
@@ -44,6 +44,12 @@ public:
 
     virtual void update(float dt) override;
 
+    [[nodiscard]] bool
+    resetForReuse() override
+    {
+        return resetToConstructed<cSprite>();
+    }
+
 private:
     std::string texturePath = "";
 
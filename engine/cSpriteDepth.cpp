@@ -9,7 +9,7 @@
 #include "jleRendering.h"
 
 cSpriteDepth::cSpriteDepth(jleObject *owner, jleScene *scene)
-    : jleComponent{owner, scene} {}
+    : jleRenderComponent{owner, scene} {}
 
 void cSpriteDepth::createAndSetTextureFromPath(const std::string &pathDiffuse,
                                                const std::string &pathHeight,
@@ -54,9 +54,11 @@ void cSpriteDepth::update(float dt)
         return;
     }
 
+#ifndef BUILD_HEADLESS
     if (quad.mtextureWithHeightmap->normalmap) {
         gCore->quadRendering().sendTexturedHeightQuad(*&quad);
     } else {
         gCore->quadRendering().sendSimpleTexturedHeightQuad(*&quad);
     }
+#endif
 }
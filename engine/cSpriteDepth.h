@@ -2,7 +2,7 @@
 
 #pragma once
 
-#include "jleComponent.h"
+#include "jleRenderComponent.h"
 #include "jleTransform.h"
 
 #include "jleQuads.h"
@@ -11,7 +11,7 @@
 #include <memory>
 #include <string>
 
-class cSpriteDepth : public jleComponent
+class cSpriteDepth : public jleRenderComponent
 {
     JLE_REGISTER_COMPONENT_TYPE(cSpriteDepth)
 public:
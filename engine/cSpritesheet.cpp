@@ -12,7 +12,7 @@ void cSpritesheet::start() {
 }
 
 cSpritesheet::cSpritesheet(jleObject *owner, jleScene *scene)
-    : jleComponent(owner, scene) {}
+    : jleRenderComponent(owner, scene) {}
 
 void cSpritesheet::update(float dt) {
     if (!_spritesheet) {
@@ -31,9 +31,11 @@ void cSpritesheet::update(float dt) {
         quad.textureY = _spritesheetEntityCache.frame.y;
         quad.depth = getTransform().getWorldPosition().z;
 
+#ifndef BUILD_HEADLESS
         if (quad.texture.get()) {
             gCore->quadRendering().sendTexturedQuad(quad);
         }
+#endif
     }
 }
 
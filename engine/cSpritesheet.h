@@ -2,11 +2,11 @@
 
 #pragma once
 
-#include "jleComponent.h"
+#include "jleRenderComponent.h"
 #include "jleSpritesheet.h"
 #include "jleTransform.h"
 
-class cSpritesheet : public jleComponent
+class cSpritesheet : public jleRenderComponent
 {
     JLE_REGISTER_COMPONENT_TYPE(cSpritesheet)
 public:
@@ -26,12 +26,14 @@ void cSpritesheetDepth::update(float dt) {
         _quad.textureY = _spritesheetEntityCache.frame.y;
         _quad.depth = getTransform().getWorldPosition().z;
 
+#ifndef BUILD_HEADLESS
         if (_quad.mtextureWithHeightmap->normalmap) {
             gCore->quadRendering().sendTexturedHeightQuad(*&_quad);
         }
         else if (_quad.mtextureWithHeightmap->heightmap) {
             gCore->quadRendering().sendSimpleTexturedHeightQuad(*&_quad);
         }
+#endif
     }
 }
 
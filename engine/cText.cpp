@@ -7,7 +7,7 @@
 #include "jleResource.h"
 #include "jleRendering.h"
 
-cText::cText(jleObject *owner, jleScene *scene) : jleComponent(owner, scene) {}
+cText::cText(jleObject *owner, jleScene *scene) : jleRenderComponent(owner, scene) {}
 
 JLE_EXTERN_TEMPLATE_CEREAL_CPP(cText)
 
@@ -15,6 +15,7 @@ JLE_EXTERN_TEMPLATE_CEREAL_CPP(cText)
 void cText::start() {}
 
 void cText::update(float dt) {
+#ifndef BUILD_HEADLESS
     if (!_font) {
         return;
     }
@@ -29,6 +30,7 @@ void cText::update(float dt) {
                                         _colorG,
                                         _colorB,
                                         _colorA);
+#endif
 }
 
 void cText::text(const std::string &text) { _text = text; }
@@ -3,11 +3,11 @@
 #pragma once
 
 #include "jleAseprite.h"
-#include "jleComponent.h"
+#include "jleRenderComponent.h"
 #include "jleFont.h"
 #include "jleTransform.h"
 
-class cText : public jleComponent
+class cText : public jleRenderComponent
 {
     JLE_REGISTER_COMPONENT_TYPE(cText)
 public:
@@ -6,6 +6,7 @@ target_include_directories(${JLE_GAME_BUILD} SYSTEM PUBLIC)
 
 option(BUILD_EDITOR "Build the game in the editor" ON)
 option(BUILD_EMSCRIPTEN "Build with Emscripten targeting WebAssembly" OFF)
+option(BUILD_HEADLESS "Build without window, graphics and audio, for simulation servers and automated tests" OFF)
 option(BUILD_OPENGLES30 "Use OpenGL ES 3.0 instead of desktop core 3.3" ON)
 option(BUILD_REMOTERY "Use Remotery profiling" ON)
 option(BUILD_UNITY "Smash compilation units into chunks for faster build times" OFF)
@@ -22,6 +23,11 @@ if (BUILD_EMSCRIPTEN)
     set(BUILD_REMOTERY OFF)
 endif ()
 
+if (BUILD_HEADLESS)
+    # The editor needs a window
+    set(BUILD_EDITOR OFF)
+endif ()
+
 add_compile_definitions(_JLE_ENGINE_PATH="${JLE_ENGINE_PATH}/")
 add_compile_definitions(_GAME_RESOURCES_DIRECTORY="${CMAKE_CURRENT_SOURCE_DIR}/GameResources")
 
@@ -45,6 +51,10 @@ if (BUILD_EDITOR)
     add_definitions(-DBUILD_EDITOR)
 endif ()
 
+if (BUILD_HEADLESS)
+    add_definitions(-DBUILD_HEADLESS)
+endif ()
+
 if (BUILD_REMOTERY)
     add_definitions(-DRMT_ENABLED)
 endif ()
@@ -52,7 +62,7 @@ endif ()
 if (BUILD_OPENGLES30)
     add_definitions(-DBUILD_OPENGLES30)
 else()
-    if (BUILD_REMOTERY)
+    if (BUILD_REMOTERY AND NOT BUILD_HEADLESS)
         # We only profile OpenGL on desktop GL, since there was problems in ES
         add_definitions(-DRMT_USE_OPENGL)
     endif ()
@@ -79,4 +89,47 @@ if (BUILD_EMSCRIPTEN)
     FILE(COPY GameResources DESTINATION ${PROJECT_BINARY_DIR})
 else ()
     FILE(COPY GameResources DESTINATION ${JLE_GAME_BUILD})
+endif ()
+
+if (NOT BUILD_EDITOR AND NOT BUILD_EMSCRIPTEN)
+    # Writes the resources with the serialized ones in the binary format to a separate directory, for shipping.
+    # The editor keeps working on the JSON resources in the source tree.
+    set(JLE_BINARY_RESOURCES_OUTPUT "${CMAKE_BINARY_DIR}/${JLE_GAME_BUILD}_binary_resources")
+
+    if (BUILD_HEADLESS)
+        add_custom_target(${JLE_GAME_BUILD}_binary_resources
+                COMMAND ${JLE_GAME_BUILD} --convert-resources binary ${JLE_BINARY_RESOURCES_OUTPUT}
+                WORKING_DIRECTORY $<TARGET_FILE_DIR:${JLE_GAME_BUILD}>
+                DEPENDS ${JLE_GAME_BUILD}
+                COMMENT "Converting serialized resources to binary")
+    else ()
+        # Loading the resources to convert them needs a window and a rendering context in other builds,
+        # so a headless copy of the game is built to run the conversion, also on machines without a display
+        include(ExternalProject)
+        set(JLE_HEADLESS_BINARY_DIR "${CMAKE_BINARY_DIR}/${JLE_GAME_BUILD}_headless")
+        set(JLE_HEADLESS_CMAKE_ARGS
+                -DBUILD_HEADLESS=ON
+                -DBUILD_EDITOR=OFF
+                -DBUILD_REMOTERY=OFF
+                -DCMAKE_BUILD_TYPE=${CMAKE_BUILD_TYPE}
+                -DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}
+                -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER})
+        if (CMAKE_TOOLCHAIN_FILE)
+            list(APPEND JLE_HEADLESS_CMAKE_ARGS -DCMAKE_TOOLCHAIN_FILE=${CMAKE_TOOLCHAIN_FILE})
+        endif ()
+        # Always built, its own build decides what is out of date, so that engine and game changes are picked up
+        ExternalProject_Add(${JLE_GAME_BUILD}_headless
+                SOURCE_DIR ${CMAKE_CURRENT_SOURCE_DIR}
+                BINARY_DIR ${JLE_HEADLESS_BINARY_DIR}
+                CMAKE_ARGS ${JLE_HEADLESS_CMAKE_ARGS}
+                BUILD_ALWAYS TRUE
+                INSTALL_COMMAND ""
+                EXCLUDE_FROM_ALL TRUE)
+        add_custom_target(${JLE_GAME_BUILD}_binary_resources
+                COMMAND ${JLE_HEADLESS_BINARY_DIR}/${JLE_GAME_BUILD}/${JLE_GAME_BUILD}${CMAKE_EXECUTABLE_SUFFIX}
+                        --convert-resources binary ${JLE_BINARY_RESOURCES_OUTPUT}
+                WORKING_DIRECTORY ${JLE_HEADLESS_BINARY_DIR}/${JLE_GAME_BUILD}
+                DEPENDS ${JLE_GAME_BUILD}_headless
+                COMMENT "Converting serialized resources to binary")
+    endif ()
 endif ()
\ No newline at end of file
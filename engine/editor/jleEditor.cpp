@@ -317,6 +317,14 @@ jleEditor::updateEditorLoadedScenes(float dt)
     }
 }
 
+bool
+jleEditor::fixedTimestepEnabled() const
+{
+    // The editor views send gizmos for rendering every frame and clear everything after
+    // rendering, which only works when the game is also updated once per frame
+    return false;
+}
+
 void
 jleEditor::update(float dt)
 {
@@ -37,7 +37,7 @@ struct jleEditorSaveState : public jleSerializedResource, public std::enable_sha
     }
 
     JLE_REGISTER_RESOURCE_TYPE(jleEditorSaveState, edsave);
-    SAVE_SHARED_THIS_SERIALIZED_JSON(jleSerializedResource)
+    SAVE_SHARED_THIS_SERIALIZED(jleSerializedResource)
 
     std::vector<jlePath> loadedScenePaths{};
     glm::vec3 cameraPosition{};
@@ -116,6 +116,8 @@ private:
 
     void exiting() override;
 
+    bool fixedTimestepEnabled() const override;
+
     void renderGameView();
 
     void renderEditorSceneView();
@@ -2,6 +2,8 @@
 
 #include "jleEditorProfilerWindow.h"
 #include "ImGui/imgui.h"
+#include "jle3DRenderer.h"
+#include "jleRendering.h"
 
 #ifdef WIN32
 #define NOMINMAX
@@ -28,6 +30,16 @@ jleEditorProfilerWindow::update(jleGameEngine &ge)
 
     ImGui::Separator();
 
+    const auto &stats3d = ge.rendering().rendering3d().stats();
+    ImGui::Text("3D GL state changes: %u (%u skipped)", stats3d.stateChanges, stats3d.stateChangesSkipped);
+    ImGui::Text("3D mesh instances: %u visible, %u culled", stats3d.meshInstancesVisible, stats3d.meshInstancesCulled);
+    ImGui::Text("3D shadow views: %u redrawn, %u reused", stats3d.shadowViewsRedrawn, stats3d.shadowViewsSkipped);
+    ImGui::Text("3D point shadows: %u lights, %u faces delayed",
+                stats3d.pointShadowLights,
+                stats3d.pointShadowFacesDelayed);
+
+    ImGui::Separator();
+
 #if RMT_ENABLED
     if (ImGui::Button("Open Remotery Profiling")) {
 #ifdef WIN32
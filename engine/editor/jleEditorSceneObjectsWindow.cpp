@@ -285,7 +285,8 @@ jleEditorSceneObjectsWindow::update(jleGameEngine &ge)
 void
 jleEditorSceneObjectsWindow::SetSelectedObject(std::shared_ptr<jleObject> object)
 {
-    selectedObject = object;
+    // Through weakPtrToThis(), so that the scene never recycles the selected object
+    selectedObject = object ? object->weakPtrToThis() : std::weak_ptr<jleObject>{};
 }
 
 void
@@ -363,7 +364,7 @@ jleEditorSceneObjectsWindow::objectTreeRecursive(std::shared_ptr<jleObject> obje
     ImGui::PopID();
 
     if (ImGui::IsItemClicked()) {
-        selectedObject = object;
+        selectedObject = object->weakPtrToThis();
     }
 
     if (ImGui::BeginDragDropTarget()) {
@@ -147,12 +147,9 @@ jleSceneEditorWindow::update(jleGameEngine &ge)
             scenes.insert(scenes.end(), gEditor->getEditorScenes().begin(), gEditor->getEditorScenes().end());
 
             for (auto &scene : scenes) {
-                for (auto &object : scene->sceneObjects()) {
-                    std::shared_ptr<jleObject> o{};
-                    object->tryFindChildWithInstanceId(pickedID, o);
-                    if (o) {
-                        gEditor->editorSceneObjects().SetSelectedObject(o);
-                    }
+                if (auto o = scene->findObjectByInstanceId(pickedID)) {
+                    gEditor->editorSceneObjects().SetSelectedObject(o->shared_from_this());
+                    break;
                 }
             }
         } else {
@@ -264,7 +261,8 @@ jleSceneEditorWindow::update(jleGameEngine &ge)
         glm::mat4 transformMatrix = obj->getTransform().getWorldMatrix();
         if (transformMatrix != worldMatrixBefore) {
             if (!gEngine->isGameKilled()) {
-                if (auto rb = obj->getComponent<cRigidbody>()) {
+                auto rb = obj->getComponent<cRigidbody>();
+                if (rb && rb->getBody()) {
                     obj->getTransform().setWorldMatrix(worldMatrixBefore);
 
                     // Remove scaling from the world matrix (bullet don't want the scaling)
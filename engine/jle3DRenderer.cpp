@@ -11,22 +11,241 @@
 #include "jleStaticOpenGLState.h"
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 
 #include "jleIncludeGL.h"
 #include "jleGLError.h"
 
 #include <glm/ext/matrix_clip_space.hpp>
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
 #include <random>
+#include <tuple>
+#include <utility>
 
 #include <RmlUi_Backend.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+void
+interpolateMesh(jle3DRenderer::jle3DRendererQueuedMesh &mesh, float alpha)
+{
+    if (alpha >= 1.f || mesh.previousTransform == mesh.targetTransform) {
+        mesh.transform = mesh.targetTransform;
+        return;
+    }
+
+    glm::vec3 previousScale, targetScale, previousTranslation, targetTranslation, skew;
+    glm::quat previousRotation, targetRotation;
+    glm::vec4 perspective;
+    glm::decompose(mesh.previousTransform, previousScale, previousRotation, previousTranslation, skew, perspective);
+    glm::decompose(mesh.targetTransform, targetScale, targetRotation, targetTranslation, skew, perspective);
+
+    mesh.transform = glm::translate(glm::mat4{1.f}, glm::mix(previousTranslation, targetTranslation, alpha)) *
+                     glm::mat4_cast(glm::slerp(previousRotation, targetRotation, alpha)) *
+                     glm::scale(glm::mat4{1.f}, glm::mix(previousScale, targetScale, alpha));
+}
+
+// Keeps meshes that can be drawn in the same instanced call next to each other
+bool
+meshDrawOrder(const jle3DRenderer::jle3DRendererQueuedMesh &a, const jle3DRenderer::jle3DRendererQueuedMesh &b)
+{
+    return std::tie(a.material, a.mesh, a.castShadows) < std::tie(b.material, b.mesh, b.castShadows);
+}
+
+// Bit offsets of the fields in a mesh batch's sort key, see jle3DRenderer::sortMeshBatches()
+constexpr int sortKeyPassShift = 62;
+constexpr int sortKeyCoarseDepthShift = 58;
+constexpr int sortKeyShaderShift = 52;
+constexpr int sortKeyTexturesShift = 40;
+constexpr int sortKeyMaterialShift = 30;
+constexpr int sortKeyVertexArrayShift = 20;
+
+uint64_t
+sortKeyField(uint64_t value, int bits, int shift)
+{
+    return (value & ((uint64_t{1} << bits) - 1)) << shift;
+}
+
+// Positive floats keep their order when compared as integers. The fine depth is the exponent
+// and the top 12 mantissa bits of the distance. The coarse bucket is the exponent alone, one
+// bucket per doubling of the distance between 0.5 and 8192, nearer and farther ones are clamped.
+uint64_t
+sortKeyDepth(float distance)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &distance, sizeof(bits));
+    const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    const int bucket = std::clamp(exponent + 2, 0, 15);
+    return sortKeyField(bucket, 4, sortKeyCoarseDepthShift) | sortKeyField(bits >> 11, 20, 0);
+}
+
+// Least significant digit first, skipping digits that are the same for all items
+template <typename T>
+void
+radixSort(std::vector<T> &items, std::vector<T> &scratch)
+{
+    scratch.resize(items.size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::array<uint32_t, 257> offsets{};
+        for (auto &&item : items) {
+            offsets[((item.key >> shift) & 0xFF) + 1]++;
+        }
+        if (std::find(offsets.begin(), offsets.end(), items.size()) != offsets.end()) {
+            continue;
+        }
+        for (std::size_t i = 1; i < offsets.size(); i++) {
+            offsets[i] += offsets[i - 1];
+        }
+        for (auto &&item : items) {
+            scratch[offsets[(item.key >> shift) & 0xFF]++] = item;
+        }
+        std::swap(items, scratch);
+    }
+}
+
+// Rendered frames a mesh proxy has to stay in place before its shadow is cached
+constexpr uint32_t staticShadowCasterFrames = 60;
+
+// Rendered frames a point shadow slot is kept after its light was last seen
+constexpr uint32_t pointShadowSlotKeepFrames = 30;
+
+// Point shadow faces in the order of cube map faces, +X -X +Y -Y +Z -Z, each rendered the way the face of a
+// cube map is, so that the shader can pick the face and coordinates like a cube map lookup
+glm::mat4
+pointShadowFaceMatrix(const glm::vec3 &lightPosition, float radius, int face)
+{
+    static const std::array<std::pair<glm::vec3, glm::vec3>, 6> faceDirections{{{{1.f, 0.f, 0.f}, {0.f, -1.f, 0.f}},
+                                                                                {{-1.f, 0.f, 0.f}, {0.f, -1.f, 0.f}},
+                                                                                {{0.f, 1.f, 0.f}, {0.f, 0.f, 1.f}},
+                                                                                {{0.f, -1.f, 0.f}, {0.f, 0.f, -1.f}},
+                                                                                {{0.f, 0.f, 1.f}, {0.f, -1.f, 0.f}},
+                                                                                {{0.f, 0.f, -1.f}, {0.f, -1.f, 0.f}}}};
+
+    // The far plane at the light's radius leaves out the casters it doesn't reach
+    constexpr float nearPlane = 0.05f;
+    const auto projection = glm::perspective(glm::radians(90.f), 1.f, nearPlane, std::max(radius, nearPlane * 2.f));
+    const auto &[forward, up] = faceDirections[face];
+    return projection * glm::lookAt(lightPosition, lightPosition + forward, up);
+}
+
+// Light clusters, see jle3DRenderer::buildLightClusters()
+constexpr int clusterTilesX = 16;
+constexpr int clusterTilesY = 9;
+constexpr int clusterSlices = 24;
+
+// Width of the light data and light index textures, longer data continues on the next row
+constexpr int clusterTextureWidth = 1024;
+
+int
+clusterTextureRows(std::size_t texels)
+{
+    return std::max(1, static_cast<int>((texels + clusterTextureWidth - 1) / clusterTextureWidth));
+}
+
+// Planes of the frustum from the rows of the matrix, pointing inwards and normalized
+std::array<glm::vec4, 6>
+frustumPlanes(const glm::mat4 &viewProjection)
+{
+    const auto rows = glm::transpose(viewProjection);
+    std::array<glm::vec4, 6> planes{rows[3] + rows[0],
+                                    rows[3] - rows[0],
+                                    rows[3] + rows[1],
+                                    rows[3] - rows[1],
+                                    rows[3] + rows[2],
+                                    rows[3] - rows[2]};
+    for (auto &&plane : planes) {
+        plane /= glm::length(glm::vec3{plane});
+    }
+    return planes;
+}
+
+// If any part of the box may be in front of all of the planes
+bool
+boxInFrustum(const std::array<glm::vec4, 6> &planes, const glm::vec3 &min, const glm::vec3 &max)
+{
+    for (auto &&plane : planes) {
+        // The corner furthest along the plane's normal
+        const glm::vec3 corner{plane.x >= 0.f ? max.x : min.x,
+                               plane.y >= 0.f ? max.y : min.y,
+                               plane.z >= 0.f ? max.z : min.z};
+        if (glm::dot(glm::vec3{plane}, corner) + plane.w < 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sets visible to 0 for the spheres completely behind any of the planes, and 1 for the rest.
+// The arrays are padded to a multiple of four.
+void
+cullSpheres(const std::array<glm::vec4, 6> &planes,
+            const float *x,
+            const float *y,
+            const float *z,
+            const float *radius,
+            std::size_t count,
+            uint8_t *visible)
+{
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    for (std::size_t i = 0; i < count; i += 4) {
+        const __m128 sx = _mm_loadu_ps(x + i);
+        const __m128 sy = _mm_loadu_ps(y + i);
+        const __m128 sz = _mm_loadu_ps(z + i);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+        __m128 outside = _mm_setzero_ps();
+        for (auto &&plane : planes) {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(sy, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(sz, _mm_set1_ps(plane.z)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+        }
+
+        const int mask = _mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++) {
+            visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+        }
+    }
+#else
+    for (std::size_t i = 0; i < count; i++) {
+        bool outside = false;
+        for (auto &&plane : planes) {
+            outside |= plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w < -radius[i];
+        }
+        visible[i] = outside ? 0 : 1;
+    }
+#endif
+}
+
+glm::vec4
+pickingColor(int instanceId)
+{
+    int r = (instanceId & 0x000000FF) >> 0;
+    int g = (instanceId & 0x0000FF00) >> 8;
+    int b = (instanceId & 0x00FF0000) >> 16;
+    return glm::vec4{r / 255.0f, g / 255.0f, b / 255.0f, 1.f};
+}
+} // namespace
+
 jle3DRenderer::jle3DRenderer()
     : _exampleCubeShader{jlePath{"ER:shaders/exampleCube.sh"}},
       _defaultMeshShader{jlePath{"ER:shaders/defaultMesh.sh"}}, _skyboxShader{jlePath{"ER:shaders/skybox.sh"}},
       _pickingShader{jlePath{"ER:shaders/picking.sh"}}, _shadowMappingShader{jlePath{"ER:shaders/shadowMapping.sh"}},
       _shadowMappingPointShader{jlePath{"ER:shaders/shadowMappingPoint.sh"}},
-      _debugDepthQuad{jlePath{"ER:shaders/depthDebug.sh"}}, _linesShader{jlePath{"ER:shaders/lines.sh"}}
+      _debugDepthQuad{jlePath{"ER:shaders/depthDebug.sh"}}, _linesShader{jlePath{"ER:shaders/lines.sh"}},
+      _meshUniforms{*_defaultMeshShader}, _shadowMappingCascade{*_shadowMappingShader, "shadowCascade"}
 {
 
     // Generate buffers for line drawing
@@ -49,6 +268,25 @@ jle3DRenderer::jle3DRenderer()
     glBindVertexArray(0);
     // End gen buffers for line drawing
 
+    // Shared by all mesh draws, each instanced draw points the mesh's VAO at its range
+    glGenBuffers(1, &_meshInstanceBuffer);
+    glGenBuffers(1, &_culledInstanceBuffer);
+
+    glGenBuffers(1, &_cameraUniformBuffer);
+    glGenBuffers(1, &_lightsUniformBuffer);
+    glGenBuffers(1, &_shadowsUniformBuffer);
+
+    // Integer and float textures read with texelFetch, they can't be filtered
+    for (auto texture : {&_clusterLightsTexture, &_clusterGridTexture, &_clusterIndicesTexture}) {
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
     constexpr float exampleCubeData[] = {
         // clang-format off
     // Vertex position XYZ,		        Color RGB
@@ -141,15 +379,11 @@ jle3DRenderer::jle3DRenderer()
     glBindVertexArray(0);
 
     _shadowMappingFramebuffer = std::make_unique<jleFramebufferShadowMap>(2048, 2048);
-    _pointsShadowMappingFramebuffer = std::make_unique<jleFramebufferShadowCubeMap>(1024, 1024);
-
-    glm::mat4 lightProjection = glm::ortho(-100.0f, 100.0f, -100.0f, 100.0f, near_plane, far_plane);
-    jleCameraSimpleFPVController jc;
-    glm::mat4 lightView =
-        glm::lookAt(glm::vec3(-2.0f, 4.0f, -1.0f), glm::vec3(2.0f, 3.0f, 2.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-    lightView[1][1] *= -1.f;
 
-    _lightSpaceMatrix = lightProjection * lightView;
+    constexpr unsigned int atlasWidth = JLE_POINT_SHADOW_FACE_SIZE * 6;
+    constexpr unsigned int atlasHeight = JLE_POINT_SHADOW_FACE_SIZE * JLE_POINT_SHADOW_SLOTS;
+    _pointShadowAtlasFramebuffer = std::make_unique<jleFramebufferShadowMap>(atlasWidth, atlasHeight);
+    _staticPointShadowAtlasFramebuffer = std::make_unique<jleFramebufferShadowMap>(atlasWidth, atlasHeight);
 }
 
 jle3DRenderer::~jle3DRenderer()
@@ -160,6 +394,17 @@ jle3DRenderer::~jle3DRenderer()
 
     glDeleteBuffers(1, &_lineVBO);
     glDeleteVertexArrays(1, &_lineVAO);
+
+    glDeleteBuffers(1, &_meshInstanceBuffer);
+    glDeleteBuffers(1, &_culledInstanceBuffer);
+
+    glDeleteBuffers(1, &_cameraUniformBuffer);
+    glDeleteBuffers(1, &_lightsUniformBuffer);
+    glDeleteBuffers(1, &_shadowsUniformBuffer);
+
+    glDeleteTextures(1, &_clusterLightsTexture);
+    glDeleteTextures(1, &_clusterGridTexture);
+    glDeleteTextures(1, &_clusterIndicesTexture);
 }
 
 void
@@ -176,9 +421,15 @@ jle3DRenderer::render(jleFramebufferInterface &framebufferOut,
 {
     JLE_SCOPE_PROFILE_CPU(jle3DRenderer_render)
 
+    prepareMeshBatches();
     const int viewportWidth = framebufferOut.width();
     const int viewportHeight = framebufferOut.height();
 
+    updateShadowCascades(camera);
+    _pointShadowViews.push_back({frustumPlanes(camera.getProjectionViewMatrix()), camera.getPosition()});
+    uploadCameraBlock(camera);
+    uploadLightingBlocks(camera, viewportWidth, viewportHeight);
+
     glEnable(GL_DEPTH_TEST);
 
     // Directional light renders to the shadow mapping framebuffer
@@ -186,7 +437,11 @@ jle3DRenderer::render(jleFramebufferInterface &framebufferOut,
 
     glCheckError("3D Render - Directional Lights");
 
-    renderPointLights(camera);
+    // The point shadow atlas is shared by all cameras, so it is only rendered by the first one each frame
+    if (_pointShadowAtlasFrame != _frame) {
+        _pointShadowAtlasFrame = _frame;
+        renderPointLights();
+    }
 
     glCheckError("3D Render - Point Lights");
 
@@ -202,7 +457,7 @@ jle3DRenderer::render(jleFramebufferInterface &framebufferOut,
     // glEnable(GL_CULL_FACE);
     glCullFace(GL_FRONT);
 
-    renderMeshes(camera, _queuedMeshes);
+    renderMeshes(camera);
 
     glCheckError("3D Render - Meshes");
 
@@ -250,13 +505,281 @@ jle3DRenderer::sendExampleCube(const glm::mat4 &transform)
 void
 jle3DRenderer::clearBuffersForNextFrame()
 {
+    if (!_queuedMeshes.empty() || !_movedMeshProxies.empty()) {
+        _meshBatchesDirty = true;
+    }
+
     _queuedExampleCubes.clear();
     _queuedMeshes.clear();
     _queuedLights.clear();
+
+    // Proxies that moved in the step that was just rendered stay where they ended up
+    for (auto &&key : _movedMeshProxies) {
+        auto it = _meshProxyIndices.find(key);
+        if (it == _meshProxyIndices.end()) {
+            continue;
+        }
+        auto &proxy = _meshProxies[it->second];
+        proxy.previousTransform = proxy.targetTransform;
+        proxy.transform = proxy.targetTransform;
+        _meshProxyKeys[it->second].moved = false;
+    }
+    _movedMeshProxies.clear();
+
     _queuedLineStrips.clear();
     _queuedLines.clear();
 }
 
+void
+jle3DRenderer::beginFrame()
+{
+    _stats = {};
+
+    // Proxies that stayed in place long enough have their shadows cached again
+    _frame++;
+    for (std::size_t i = 0; i < _dynamicMeshProxies.size();) {
+        auto it = _meshProxyIndices.find(_dynamicMeshProxies[i]);
+        if (it != _meshProxyIndices.end()) {
+            auto &proxyKey = _meshProxyKeys[it->second];
+            if (_frame - proxyKey.lastMovedFrame < staticShadowCasterFrames) {
+                i++;
+                continue;
+            }
+            proxyKey.isStatic = true;
+            _meshBatchesDirty = true;
+            if (_meshProxies[it->second].castShadows) {
+                invalidateStaticShadows(_meshProxies[it->second]);
+            }
+        }
+        _dynamicMeshProxies[i] = _dynamicMeshProxies.back();
+        _dynamicMeshProxies.pop_back();
+    }
+
+    assignPointShadowSlots();
+    _pointShadowViews.clear();
+}
+
+jle3DRenderer::jle3DRendererMeshUniforms::jle3DRendererMeshUniforms(const jleShader &shader)
+    : shadowMap{shader, "shadowMap"}, shadowMapPoint{shader, "shadowMapPoint"}, albedoTexture{shader, "albedoTexture"},
+      normalTexture{shader, "normalTexture"}, skyboxTexture{shader, "skyboxTexture"},
+      clusterLightsTexture{shader, "ClusterLightsTexture"}, clusterGridTexture{shader, "ClusterGridTexture"},
+      clusterIndicesTexture{shader, "ClusterIndicesTexture"}, useAlbedoTexture{shader, "useAlbedoTexture"}, useNormalTexture{shader, "useNormalTexture"}
+{
+}
+
+void
+jle3DRenderer::uploadCameraBlock(const jleCamera &camera)
+{
+    jle3DRendererCameraBlock block{};
+    block.view = camera.getViewMatrix();
+    block.proj = camera.getProjectionMatrix();
+    block.projView = camera.getProjectionViewMatrix();
+    block.position = glm::vec4{camera.getPosition(), 1.f};
+    uploadUniformBlock(jleUniformBlockBinding::Camera, _cameraUniformBuffer, &block, sizeof(block));
+}
+
+void
+jle3DRenderer::uploadLightingBlocks(const jleCamera &camera, int viewportWidth, int viewportHeight)
+{
+    jle3DRendererLightsBlock lights{};
+    buildLightClusters(camera, viewportWidth, viewportHeight, lights);
+    uploadLightClusters();
+
+    lights.directionalLightColour = glm::vec4{_directionalLightColour, 1.f};
+    lights.directionalLightDir = glm::vec4{_directionalLightRotation, 0.f};
+    lights.useDirectionalLight = _useDirectionalLight;
+    lights.useEnvironmentMapping = _useEnvironmentMapping;
+    uploadUniformBlock(jleUniformBlockBinding::Lights, _lightsUniformBuffer, &lights, sizeof(lights));
+
+    jle3DRendererShadowsBlock shadows{};
+    for (int i = 0; i < JLE_SHADOW_CASCADE_COUNT; i++) {
+        shadows.cascadeMatrices[i] = _cascadeView->cascades[i].matrix;
+        shadows.cascadeSplits[i] = _cascadeView->cascades[i].splitDepth;
+    }
+    shadows.pointShadowFace = glm::vec4{1.f / 6.f,
+                                        1.f / JLE_POINT_SHADOW_SLOTS,
+                                        0.5f / JLE_POINT_SHADOW_FACE_SIZE,
+                                        0.5f / JLE_POINT_SHADOW_FACE_SIZE};
+    uploadUniformBlock(jleUniformBlockBinding::Shadows, _shadowsUniformBuffer, &shadows, sizeof(shadows));
+}
+
+void
+jle3DRenderer::buildLightClusters(const jleCamera &camera,
+                                  int viewportWidth,
+                                  int viewportHeight,
+                                  jle3DRendererLightsBlock &lights)
+{
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_buildLightClusters)
+
+    const bool perspective = camera.getProjectionType() == jleCameraProjection::Perspective;
+    const float nearPlane = perspective ? std::max(camera.getNearPlane(), 0.001f) : camera.getNearPlane();
+    const float farPlane = std::max(camera.getFarPlane(), nearPlane + 0.001f);
+
+    // Perspective slices are spaced logarithmically, so that near slices aren't much deeper than they are wide
+    float sliceScale, sliceBias;
+    if (perspective) {
+        sliceScale = clusterSlices / std::log(farPlane / nearPlane);
+        sliceBias = -std::log(nearPlane) * sliceScale;
+    } else {
+        sliceScale = clusterSlices / (farPlane - nearPlane);
+        sliceBias = -nearPlane * sliceScale;
+    }
+
+    lights.clusterScale = {static_cast<float>(clusterTilesX) / std::max(viewportWidth, 1),
+                           static_cast<float>(clusterTilesY) / std::max(viewportHeight, 1),
+                           sliceScale,
+                           sliceBias};
+    lights.clusterDimensions = {clusterTilesX, clusterTilesY, clusterSlices, perspective ? 1 : 0};
+
+    auto slice = [&](float depth) {
+        const float clusterDepth = perspective ? std::log(depth) : depth;
+        return std::clamp(static_cast<int>(std::floor(clusterDepth * sliceScale + sliceBias)), 0, clusterSlices - 1);
+    };
+    auto tile = [](float ndc, int tiles) {
+        return std::clamp(static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * tiles)), 0, tiles - 1);
+    };
+
+    const auto view = camera.getViewMatrix();
+    const auto projection = camera.getProjectionMatrix();
+
+    _clusterLightData.clear();
+    _lightClusterRanges.clear();
+    _clusterGrid.assign(clusterTilesX * clusterTilesY * clusterSlices, glm::uvec2{0});
+
+    for (uint32_t l = 0; l < _queuedLights.size(); l++) {
+        const auto &light = _queuedLights[l];
+        _clusterLightData.emplace_back(light.position, light.radius);
+        _clusterLightData.emplace_back(light.color, static_cast<float>(light.shadowSlot));
+
+        // View space looks down -z
+        const glm::vec3 center{view * glm::vec4{light.position, 1.f}};
+        const float minDepth = std::max(-center.z - light.radius, nearPlane);
+        const float maxDepth = std::min(-center.z + light.radius, farPlane);
+        if (minDepth > maxDepth) {
+            continue;
+        }
+
+        // The light's bounding box in view space, clipped to the depth range, projects
+        // within the bounds of its projected corners
+        glm::vec2 ndcMin{FLT_MAX}, ndcMax{-FLT_MAX};
+        for (int corner = 0; corner < 8; corner++) {
+            const glm::vec4 position{center.x + (corner & 1 ? light.radius : -light.radius),
+                                     center.y + (corner & 2 ? light.radius : -light.radius),
+                                     corner & 4 ? -maxDepth : -minDepth,
+                                     1.f};
+            const auto clip = projection * position;
+            const glm::vec2 ndc = glm::vec2{clip} / clip.w;
+            ndcMin = glm::min(ndcMin, ndc);
+            ndcMax = glm::max(ndcMax, ndc);
+        }
+        if (ndcMax.x < -1.f || ndcMax.y < -1.f || ndcMin.x > 1.f || ndcMin.y > 1.f) {
+            continue;
+        }
+
+        const jle3DRendererLightClusterRange range{l,
+                                                   tile(ndcMin.x, clusterTilesX),
+                                                   tile(ndcMax.x, clusterTilesX),
+                                                   tile(ndcMin.y, clusterTilesY),
+                                                   tile(ndcMax.y, clusterTilesY),
+                                                   slice(minDepth),
+                                                   slice(maxDepth)};
+        _lightClusterRanges.push_back(range);
+
+        for (int z = range.minSlice; z <= range.maxSlice; z++) {
+            for (int y = range.minY; y <= range.maxY; y++) {
+                for (int x = range.minX; x <= range.maxX; x++) {
+                    _clusterGrid[(z * clusterTilesY + y) * clusterTilesX + x].y++;
+                }
+            }
+        }
+    }
+
+    // Each cluster's list starts where the previous cluster's ends, the counts are filled in again below
+    uint32_t offset = 0;
+    for (auto &&cluster : _clusterGrid) {
+        cluster.x = offset;
+        offset += cluster.y;
+        cluster.y = 0;
+    }
+
+    _clusterLightIndices.resize(offset);
+    for (auto &&range : _lightClusterRanges) {
+        for (int z = range.minSlice; z <= range.maxSlice; z++) {
+            for (int y = range.minY; y <= range.maxY; y++) {
+                for (int x = range.minX; x <= range.maxX; x++) {
+                    auto &cluster = _clusterGrid[(z * clusterTilesY + y) * clusterTilesX + x];
+                    _clusterLightIndices[cluster.x + cluster.y++] = range.light;
+                }
+            }
+        }
+    }
+}
+
+void
+jle3DRenderer::uploadLightClusters()
+{
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_uploadLightClusters)
+
+    // Padded to whole rows, the padding is never read
+    const int lightRows = clusterTextureRows(_clusterLightData.size());
+    const int indexRows = clusterTextureRows(_clusterLightIndices.size());
+    _clusterLightData.resize(lightRows * clusterTextureWidth);
+    _clusterLightIndices.resize(indexRows * clusterTextureWidth);
+
+    glBindTexture(GL_TEXTURE_2D, _clusterLightsTexture);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_RGBA32F,
+                 clusterTextureWidth,
+                 lightRows,
+                 0,
+                 GL_RGBA,
+                 GL_FLOAT,
+                 _clusterLightData.data());
+
+    glBindTexture(GL_TEXTURE_2D, _clusterGridTexture);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_RG32UI,
+                 clusterTilesX * clusterTilesY,
+                 clusterSlices,
+                 0,
+                 GL_RG_INTEGER,
+                 GL_UNSIGNED_INT,
+                 _clusterGrid.data());
+
+    glBindTexture(GL_TEXTURE_2D, _clusterIndicesTexture);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_R32UI,
+                 clusterTextureWidth,
+                 indexRows,
+                 0,
+                 GL_RED_INTEGER,
+                 GL_UNSIGNED_INT,
+                 _clusterLightIndices.data());
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void
+jle3DRenderer::uploadUniformBlock(jleUniformBlockBinding binding,
+                                  unsigned int buffer,
+                                  const void *data,
+                                  std::size_t size)
+{
+    // Orphans the previous frame's data instead of waiting for draws still reading it
+    glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(binding), buffer);
+    glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+const jle3DRenderer::jle3DRendererStats &
+jle3DRenderer::stats() const
+{
+    return _stats;
+}
+
 void
 jle3DRenderer::renderExampleCubes(const jleCamera &camera, const std::vector<glm::mat4> &cubeTransforms)
 {
@@ -282,15 +805,431 @@ jle3DRenderer::sendMesh(std::shared_ptr<jleMesh> &mesh,
                         int instanceId,
                         bool castShadows)
 {
-    _queuedMeshes.push_back({transform, mesh, material, instanceId, castShadows});
+    _queuedMeshes.push_back({transform, mesh, material, instanceId, castShadows, transform, transform});
+    _meshBatchesDirty = true;
+}
+
+void
+jle3DRenderer::sendMesh(std::shared_ptr<jleMesh> &mesh,
+                        std::shared_ptr<jleMaterial> &material,
+                        const glm::mat4 &transform,
+                        const glm::mat4 &previousTransform,
+                        int instanceId,
+                        bool castShadows)
+{
+    _queuedMeshes.push_back({transform, mesh, material, instanceId, castShadows, previousTransform, transform});
+    _meshBatchesDirty = true;
 }
 
 void
-jle3DRenderer::renderMeshes(const jleCamera &camera, const std::vector<jle3DRendererQueuedMesh> &meshes)
+jle3DRenderer::setMeshProxy(const void *key,
+                            const std::shared_ptr<jleMesh> &mesh,
+                            const std::shared_ptr<jleMaterial> &material,
+                            const glm::mat4 &transform,
+                            int instanceId,
+                            bool castShadows)
+{
+    auto it = _meshProxyIndices.find(key);
+    if (it == _meshProxyIndices.end()) {
+        _meshProxyIndices.emplace(key, _meshProxies.size());
+        _meshProxies.push_back({transform, mesh, material, instanceId, castShadows, transform, transform});
+        _meshProxyKeys.push_back({key, false, false, _frame});
+        _dynamicMeshProxies.push_back(key);
+        _meshProxiesNeedSort = true;
+        _meshBatchesDirty = true;
+        return;
+    }
+
+    auto &proxy = _meshProxies[it->second];
+    if (proxy.mesh != mesh || proxy.material != material || proxy.castShadows != castShadows) {
+        const bool invalidate = _meshProxyKeys[it->second].isStatic && (proxy.castShadows || castShadows);
+        if (invalidate) {
+            invalidateStaticShadows(proxy);
+        }
+        proxy.mesh = mesh;
+        proxy.material = material;
+        proxy.castShadows = castShadows;
+        if (invalidate) {
+            invalidateStaticShadows(proxy);
+        }
+        _meshProxiesNeedSort = true;
+        _meshBatchesDirty = true;
+    }
+    if (proxy.instanceId != instanceId) {
+        proxy.instanceId = instanceId;
+        _meshBatchesDirty = true;
+    }
+
+    if (proxy.targetTransform != transform) {
+        setMeshProxyTransform(key, transform);
+    }
+}
+
+void
+jle3DRenderer::setMeshProxyTransform(const void *key, const glm::mat4 &transform)
+{
+    auto it = _meshProxyIndices.find(key);
+    if (it == _meshProxyIndices.end()) {
+        return;
+    }
+
+    auto &proxy = _meshProxies[it->second];
+    auto &proxyKey = _meshProxyKeys[it->second];
+    if (!proxyKey.moved) {
+        proxyKey.moved = true;
+        proxy.previousTransform = proxy.targetTransform;
+        _movedMeshProxies.push_back(key);
+    }
+    if (proxyKey.isStatic) {
+        proxyKey.isStatic = false;
+        _dynamicMeshProxies.push_back(key);
+        if (proxy.castShadows) {
+            invalidateStaticShadows(proxy);
+        }
+    }
+    proxyKey.lastMovedFrame = _frame;
+    proxy.targetTransform = transform;
+    proxy.transform = transform;
+    _meshBatchesDirty = true;
+}
+
+void
+jle3DRenderer::removeMeshProxy(const void *key)
+{
+    auto it = _meshProxyIndices.find(key);
+    if (it == _meshProxyIndices.end()) {
+        return;
+    }
+
+    const auto index = it->second;
+    _meshProxyIndices.erase(it);
+    _meshBatchesDirty = true;
+
+    if (_meshProxyKeys[index].isStatic && _meshProxies[index].castShadows) {
+        invalidateStaticShadows(_meshProxies[index]);
+    }
+
+    const auto last = _meshProxies.size() - 1;
+    if (index != last) {
+        _meshProxies[index] = std::move(_meshProxies[last]);
+        _meshProxyKeys[index] = _meshProxyKeys[last];
+        _meshProxyIndices[_meshProxyKeys[index].key] = index;
+        _meshProxiesNeedSort = true;
+    }
+    _meshProxies.pop_back();
+    _meshProxyKeys.pop_back();
+}
+
+void
+jle3DRenderer::sortMeshProxies()
+{
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_sortMeshProxies)
+
+    std::vector<std::size_t> order(_meshProxies.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return meshDrawOrder(_meshProxies[a], _meshProxies[b]);
+    });
+
+    std::vector<jle3DRendererQueuedMesh> sortedProxies;
+    std::vector<jle3DRendererMeshProxyKey> sortedKeys;
+    sortedProxies.reserve(order.size());
+    sortedKeys.reserve(order.size());
+    for (auto index : order) {
+        _meshProxyIndices[_meshProxyKeys[index].key] = sortedProxies.size();
+        sortedProxies.push_back(std::move(_meshProxies[index]));
+        sortedKeys.push_back(_meshProxyKeys[index]);
+    }
+
+    _meshProxies = std::move(sortedProxies);
+    _meshProxyKeys = std::move(sortedKeys);
+    _meshProxiesNeedSort = false;
+}
+
+void
+jle3DRenderer::prepareMeshBatches()
+{
+    if (!_meshBatchesDirty) {
+        return;
+    }
+
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_prepareMeshBatches)
+
+    if (_meshProxiesNeedSort) {
+        sortMeshProxies();
+    }
+
+    _meshInstances.clear();
+    _meshBatches.clear();
+    _instanceSphereX.clear();
+    _instanceSphereY.clear();
+    _instanceSphereZ.clear();
+    _instanceSphereRadius.clear();
+    _instanceStatic.clear();
+
+    const uint64_t shaderKey = sortKeyField(_defaultMeshShader->ID, 6, sortKeyShaderShift);
+    uint64_t materialRank = 0;
+
+    auto addInstance = [&](const jle3DRendererQueuedMesh &mesh, bool isStatic) {
+        const glm::vec3 position{mesh.transform[3]};
+        if (_meshBatches.empty() || _meshBatches.back().mesh != mesh.mesh.get() ||
+            _meshBatches.back().material != mesh.material.get() ||
+            _meshBatches.back().castShadows != mesh.castShadows) {
+            if (!_meshBatches.empty() && _meshBatches.back().material != mesh.material.get()) {
+                materialRank++;
+            }
+
+            uint64_t textures = 0;
+            if (mesh.material && mesh.material->albedoTextureRef) {
+                textures |= sortKeyField(mesh.material->albedoTextureRef.get()->id(), 6, 6);
+            }
+            if (mesh.material && mesh.material->normalTextureRef) {
+                textures |= sortKeyField(mesh.material->normalTextureRef.get()->id(), 6, 0);
+            }
+
+            const uint64_t stateKey = shaderKey | sortKeyField(textures, 12, sortKeyTexturesShift) |
+                                      sortKeyField(materialRank, 10, sortKeyMaterialShift) |
+                                      sortKeyField(mesh.mesh->getVAO(), 10, sortKeyVertexArrayShift);
+
+            _meshBatches.push_back({mesh.mesh.get(),
+                                    mesh.material.get(),
+                                    mesh.castShadows,
+                                    static_cast<int>(_meshInstances.size()),
+                                    0,
+                                    stateKey,
+                                    position,
+                                    position});
+        }
+
+        auto &batch = _meshBatches.back();
+        batch.instanceCount++;
+        batch.boundsMin = glm::min(batch.boundsMin, position);
+        batch.boundsMax = glm::max(batch.boundsMax, position);
+        _meshInstances.push_back({mesh.transform, pickingColor(mesh.instanceId)});
+
+        const glm::vec3 center{mesh.transform * glm::vec4{mesh.mesh->boundingSphereCenter(), 1.f}};
+        const float scale = std::sqrt(std::max({glm::dot(glm::vec3{mesh.transform[0]}, glm::vec3{mesh.transform[0]}),
+                                                glm::dot(glm::vec3{mesh.transform[1]}, glm::vec3{mesh.transform[1]}),
+                                                glm::dot(glm::vec3{mesh.transform[2]}, glm::vec3{mesh.transform[2]})}));
+        _instanceSphereX.push_back(center.x);
+        _instanceSphereY.push_back(center.y);
+        _instanceSphereZ.push_back(center.z);
+        _instanceSphereRadius.push_back(mesh.mesh->boundingSphereRadius() * scale);
+        _instanceStatic.push_back(isStatic);
+    };
+
+    // Proxies are already sorted, the few meshes sent this frame are grouped the same way
+    for (std::size_t i = 0; i < _meshProxies.size(); i++) {
+        addInstance(_meshProxies[i], _meshProxyKeys[i].isStatic);
+    }
+
+    std::vector<const jle3DRendererQueuedMesh *> queued;
+    queued.reserve(_queuedMeshes.size());
+    for (auto &&mesh : _queuedMeshes) {
+        queued.push_back(&mesh);
+    }
+    std::sort(queued.begin(), queued.end(), [](auto a, auto b) { return meshDrawOrder(*a, *b); });
+    for (auto mesh : queued) {
+        addInstance(*mesh, false);
+    }
+
+    const auto paddedCount = (_meshInstances.size() + 3) & ~std::size_t{3};
+    _instanceSphereX.resize(paddedCount);
+    _instanceSphereY.resize(paddedCount);
+    _instanceSphereZ.resize(paddedCount);
+    _instanceSphereRadius.resize(paddedCount);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _meshInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER,
+                 _meshInstances.size() * sizeof(jle3DRendererMeshInstance),
+                 _meshInstances.data(),
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _meshBatchesDirty = false;
+}
+
+void
+jle3DRenderer::cullMeshBatches(const glm::mat4 &viewProjection, jle3DRendererCullMode mode)
+{
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_cullMeshBatches)
+
+    _instanceVisible.resize(_instanceSphereX.size());
+    cullSpheres(frustumPlanes(viewProjection),
+                _instanceSphereX.data(),
+                _instanceSphereY.data(),
+                _instanceSphereZ.data(),
+                _instanceSphereRadius.data(),
+                _instanceSphereX.size(),
+                _instanceVisible.data());
+
+    _visibleBatches.clear();
+    _culledInstances.clear();
+    for (uint32_t b = 0; b < _meshBatches.size(); b++) {
+        const auto &batch = _meshBatches[b];
+        if (mode != jle3DRendererCullMode::Visible && !batch.castShadows) {
+            continue;
+        }
+
+        // Shadow casters are drawn in separate passes for static and dynamic instances
+        const bool filterStatic = mode != jle3DRendererCullMode::Visible;
+        const bool wantStatic = mode == jle3DRendererCullMode::StaticShadowCasters;
+        auto included = [&](int i) {
+            return _instanceVisible[i] && (!filterStatic || (_instanceStatic[i] != 0) == wantStatic);
+        };
+
+        int candidateCount = 0, visibleCount = 0;
+        for (int i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; i++) {
+            if (!filterStatic || (_instanceStatic[i] != 0) == wantStatic) {
+                candidateCount++;
+                visibleCount += _instanceVisible[i];
+            }
+        }
+        _stats.meshInstancesVisible += visibleCount;
+        _stats.meshInstancesCulled += candidateCount - visibleCount;
+
+        if (visibleCount == 0) {
+            continue;
+        }
+        if (visibleCount == batch.instanceCount) {
+            _visibleBatches.push_back({b, _meshInstanceBuffer, batch.firstInstance, batch.instanceCount});
+            continue;
+        }
+
+        _visibleBatches.push_back({b, _culledInstanceBuffer, static_cast<int>(_culledInstances.size()), visibleCount});
+        for (int i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; i++) {
+            if (included(i)) {
+                _culledInstances.push_back(_meshInstances[i]);
+            }
+        }
+    }
+
+    // Uploading again orphans the storage still read by the previous pass' draws
+    if (!_culledInstances.empty()) {
+        glBindBuffer(GL_ARRAY_BUFFER, _culledInstanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER,
+                     _culledInstances.size() * sizeof(jle3DRendererMeshInstance),
+                     _culledInstances.data(),
+                     GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void
+jle3DRenderer::sortMeshBatches(const jleCamera &camera)
+{
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_sortMeshBatches)
+
+    const auto cameraPosition = camera.getPosition();
+
+    _meshDrawOrder.clear();
+    for (uint32_t i = 0; i < _visibleBatches.size(); i++) {
+        const auto &batch = _meshBatches[_visibleBatches[i].batch];
+        const auto nearest = glm::clamp(cameraPosition, batch.boundsMin, batch.boundsMax);
+        const auto distance = glm::distance(cameraPosition, nearest);
+        _meshDrawOrder.push_back({batch.stateKey | sortKeyDepth(distance), i});
+    }
+
+    radixSort(_meshDrawOrder, _meshDrawOrderScratch);
+}
+
+void
+jle3DRenderer::resetStateCache()
+{
+    // Zero is a valid binding, so nothing is assumed to be bound
+    _stateCache.vertexArray = UINT_MAX;
+    std::fill(std::begin(_stateCache.textures2D), std::end(_stateCache.textures2D), UINT_MAX);
+}
+
+void
+jle3DRenderer::bindVertexArray(unsigned int vertexArray)
+{
+    if (_stateCache.vertexArray == vertexArray) {
+        _stats.stateChangesSkipped++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    _stateCache.vertexArray = vertexArray;
+    _stats.stateChanges++;
+}
+
+void
+jle3DRenderer::bindTexture2D(int unit, unsigned int texture)
+{
+    if (_stateCache.textures2D[unit] == texture) {
+        _stats.stateChangesSkipped++;
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    _stateCache.textures2D[unit] = texture;
+    _stats.stateChanges++;
+}
+
+void
+jle3DRenderer::drawMeshBatch(const jle3DRendererVisibleBatch &visible)
+{
+    const auto &batch = _meshBatches[visible.batch];
+    bindVertexArray(batch.mesh->getVAO());
+
+    // GL ES 3.0 has no base instance, so the attributes are pointed at the batch's range instead
+    glBindBuffer(GL_ARRAY_BUFFER, visible.instanceBuffer);
+    const auto offset = visible.firstInstance * sizeof(jle3DRendererMeshInstance);
+    for (int i = 0; i < 4; i++) {
+        glVertexAttribPointer(5 + i,
+                              4,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              sizeof(jle3DRendererMeshInstance),
+                              (void *)(offset + i * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(5 + i);
+        glVertexAttribDivisor(5 + i, 1);
+    }
+    glVertexAttribPointer(9,
+                          4,
+                          GL_FLOAT,
+                          GL_FALSE,
+                          sizeof(jle3DRendererMeshInstance),
+                          (void *)(offset + offsetof(jle3DRendererMeshInstance, pickingColor)));
+    glEnableVertexAttribArray(9);
+    glVertexAttribDivisor(9, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (batch.mesh->usesIndexing()) {
+        glDrawElementsInstanced(
+            GL_TRIANGLES, batch.mesh->getTrianglesCount(), batch.mesh->indexType(), (void *)0, visible.instanceCount);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, batch.mesh->getTrianglesCount(), visible.instanceCount);
+    }
+}
+
+void
+jle3DRenderer::interpolateQueuedMeshes(float alpha)
+{
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_interpolateQueuedMeshes)
+
+    if (!_queuedMeshes.empty() || !_movedMeshProxies.empty()) {
+        _meshBatchesDirty = true;
+    }
+
+    for (auto &&mesh : _queuedMeshes) {
+        interpolateMesh(mesh, alpha);
+    }
+
+    for (auto &&key : _movedMeshProxies) {
+        auto it = _meshProxyIndices.find(key);
+        if (it != _meshProxyIndices.end()) {
+            interpolateMesh(_meshProxies[it->second], alpha);
+        }
+    }
+}
+
+void
+jle3DRenderer::renderMeshes(const jleCamera &camera)
 {
     JLE_SCOPE_PROFILE_CPU(jle3DRenderer_renderMeshes)
 
-    if (meshes.empty()) {
+    if (_meshBatches.empty()) {
         return;
     }
 
@@ -300,85 +1239,67 @@ jle3DRenderer::renderMeshes(const jleCamera &camera, const std::vector<jle3DRend
     jleStaticOpenGLState::globalActiveTexture = _shadowMappingFramebuffer->texture();
 
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _pointsShadowMappingFramebuffer->texture());
+    glBindTexture(GL_TEXTURE_2D, _pointShadowAtlasFramebuffer->texture());
 
     if (_skybox) {
         glActiveTexture(GL_TEXTURE4);
         glBindTexture(GL_TEXTURE_CUBE_MAP, _skybox->getTextureID());
     }
 
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_2D, _clusterLightsTexture);
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_2D, _clusterGridTexture);
+    glActiveTexture(GL_TEXTURE7);
+    glBindTexture(GL_TEXTURE_2D, _clusterIndicesTexture);
+
     _defaultMeshShader->use();
-    _defaultMeshShader->SetInt("shadowMap", 0);
-    _defaultMeshShader->SetInt("shadowMapPoint", 1);
-    _defaultMeshShader->SetInt("albedoTexture", 2);
-    _defaultMeshShader->SetInt("normalTexture", 3);
-    _defaultMeshShader->SetInt("skyboxTexture", 4);
-    _defaultMeshShader->SetFloat("farPlane", 500.f);
-    _defaultMeshShader->SetBool("UseDirectionalLight", _useDirectionalLight);
-    _defaultMeshShader->SetBool("UseEnvironmentMapping", _useEnvironmentMapping);
-    _defaultMeshShader->SetVec3("DirectionalLightColour", _directionalLightColour);
-    _defaultMeshShader->SetVec3("DirectionalLightDir", _directionalLightRotation);
-    _defaultMeshShader->SetMat4("view", camera.getViewMatrix());
-    _defaultMeshShader->SetMat4("proj", camera.getProjectionMatrix());
-    _defaultMeshShader->SetMat4("lightSpaceMatrix", _lightSpaceMatrix);
-    _defaultMeshShader->SetVec3("CameraPosition", camera.getPosition());
-    _defaultMeshShader->SetInt("LightsCount", (int)_queuedLights.size());
-
-    if (_queuedLights.size() > 4) // Limit to 4 lights
-    {
-        _queuedLights.erase(_queuedLights.begin() + 4, _queuedLights.end());
-    }
-
-    for (int l = 0; l < _queuedLights.size(); l++) {
-        _defaultMeshShader->SetVec3("LightPositions[" + std::to_string(l) + "]", _queuedLights[l].position);
-        _defaultMeshShader->SetVec3("LightColors[" + std::to_string(l) + "]", _queuedLights[l].color);
-    }
-
-    for (auto &&mesh : meshes) {
-        _defaultMeshShader->SetMat4("model", mesh.transform);
-
-        // Set textures
-        if (mesh.material) {
-            if (mesh.material->albedoTextureRef) {
-                mesh.material->albedoTextureRef.get()->setActive(2);
-                _defaultMeshShader->SetBool("useAlbedoTexture", true);
-            } else {
-                _defaultMeshShader->SetBool("useAlbedoTexture", false);
-            }
-            if (mesh.material->normalTextureRef) {
-                mesh.material->normalTextureRef.get()->setActive(3);
-                _defaultMeshShader->SetBool("useNormalTexture", true);
-            } else {
-                _defaultMeshShader->SetBool("useNormalTexture", false);
-            }
-        } else {
-            _defaultMeshShader->SetBool("useAlbedoTexture", false);
-            _defaultMeshShader->SetBool("useNormalTexture", false);
+    _meshUniforms.shadowMap.set(0);
+    _meshUniforms.shadowMapPoint.set(1);
+    _meshUniforms.albedoTexture.set(2);
+    _meshUniforms.normalTexture.set(3);
+    _meshUniforms.skyboxTexture.set(4);
+    _meshUniforms.clusterLightsTexture.set(5);
+    _meshUniforms.clusterGridTexture.set(6);
+    _meshUniforms.clusterIndicesTexture.set(7);
+
+    cullMeshBatches(camera.getProjectionViewMatrix(), jle3DRendererCullMode::Visible);
+    sortMeshBatches(camera);
+    resetStateCache();
+
+    for (auto &&item : _meshDrawOrder) {
+        const auto &visible = _visibleBatches[item.index];
+        const auto &batch = _meshBatches[visible.batch];
+
+        unsigned int albedoTexture = 0, normalTexture = 0;
+        if (batch.material && batch.material->albedoTextureRef) {
+            albedoTexture = batch.material->albedoTextureRef.get()->id();
         }
-
-        glBindVertexArray(mesh.mesh->getVAO());
-        if (mesh.mesh->usesIndexing()) {
-            glDrawElements(GL_TRIANGLES, mesh.mesh->getTrianglesCount(), GL_UNSIGNED_INT, (void *)0);
-        } else {
-            glDrawArrays(GL_TRIANGLES, 0, mesh.mesh->getTrianglesCount());
+        if (batch.material && batch.material->normalTextureRef) {
+            normalTexture = batch.material->normalTextureRef.get()->id();
         }
-        glBindVertexArray(0);
 
-        // Unset textures
-        if (mesh.material) {
-            if (mesh.material->albedoTextureRef) {
-                glActiveTexture(GL_TEXTURE2);
-                glBindTexture(GL_TEXTURE_2D, 0);
-            }
-            if (mesh.material->normalTextureRef) {
-                glActiveTexture(GL_TEXTURE3);
-                glBindTexture(GL_TEXTURE_2D, 0);
-            }
+        // Only uploaded when they change
+        _meshUniforms.useAlbedoTexture.set(albedoTexture != 0);
+        _meshUniforms.useNormalTexture.set(normalTexture != 0);
+
+        if (albedoTexture) {
+            bindTexture2D(2, albedoTexture);
         }
+        if (normalTexture) {
+            bindTexture2D(3, normalTexture);
+        }
+
+        drawMeshBatch(visible);
     }
 
+    bindVertexArray(0);
+    bindTexture2D(2, 0);
+    bindTexture2D(3, 0);
+
     glActiveTexture(GL_TEXTURE0);
 }
+
 void
 jle3DRenderer::setSkybox(const std::shared_ptr<jleSkybox> &skybox)
 {
@@ -402,11 +1323,6 @@ jle3DRenderer::renderSkybox(const jleCamera &camera)
     glDepthFunc(GL_LEQUAL);
     _skyboxShader->use();
 
-    // Convert the view matrix to mat3 first to remove the translation
-    auto view = glm::mat4(glm::mat3(camera.getViewMatrix()));
-
-    _skyboxShader->SetMat4("view", view);
-    _skyboxShader->SetMat4("projection", camera.getProjectionMatrix());
     // skybox cube
     glBindVertexArray(_skybox->getVAO());
     glActiveTexture(GL_TEXTURE0);
@@ -417,9 +1333,9 @@ jle3DRenderer::renderSkybox(const jleCamera &camera)
     glDepthFunc(GL_LESS);
 }
 void
-jle3DRenderer::sendLight(const glm::vec3 &position, const glm::vec3 &color)
+jle3DRenderer::sendLight(const glm::vec3 &position, const glm::vec3 &color, float radius)
 {
-    _queuedLights.push_back({position, color});
+    _queuedLights.push_back({position, color, radius, -1});
 }
 
 void
@@ -427,6 +1343,8 @@ jle3DRenderer::renderMeshesPicking(jleFramebufferInterface &framebufferOut, cons
 {
     JLE_SCOPE_PROFILE_CPU(jle3DRenderer_renderMeshesPicking)
 
+    prepareMeshBatches();
+
     const int viewportWidth = framebufferOut.width();
     const int viewportHeight = framebufferOut.height();
 
@@ -439,23 +1357,15 @@ jle3DRenderer::renderMeshesPicking(jleFramebufferInterface &framebufferOut, cons
     // Change viewport dimensions to match framebuffer's dimensions
     glViewport(0, 0, viewportWidth, viewportHeight);
 
+    uploadCameraBlock(camera);
     _pickingShader->use();
-    _pickingShader->SetMat4("projView", camera.getProjectionViewMatrix());
 
-    for (auto &&mesh : _queuedMeshes) {
-        int r = (mesh.instanceId & 0x000000FF) >> 0;
-        int g = (mesh.instanceId & 0x0000FF00) >> 8;
-        int b = (mesh.instanceId & 0x00FF0000) >> 16;
-        _pickingShader->SetVec4("PickingColor", glm::vec4{r / 255.0f, g / 255.0f, b / 255.0f, 1.f});
-        _pickingShader->SetMat4("model", mesh.transform);
-        glBindVertexArray(mesh.mesh->getVAO());
-        if (mesh.mesh->usesIndexing()) {
-            glDrawElements(GL_TRIANGLES, mesh.mesh->getTrianglesCount(), GL_UNSIGNED_INT, (void *)0);
-        } else {
-            glDrawArrays(GL_TRIANGLES, 0, mesh.mesh->getTrianglesCount());
-        }
-        glBindVertexArray(0);
+    cullMeshBatches(camera.getProjectionViewMatrix(), jle3DRendererCullMode::Visible);
+    resetStateCache();
+    for (auto &&visible : _visibleBatches) {
+        drawMeshBatch(visible);
     }
+    bindVertexArray(0);
 
     framebufferOut.bindDefault();
 }
@@ -475,12 +1385,29 @@ jle3DRenderer::renderDirectionalLight(const jleCamera &camera)
 
     _shadowMappingShader->use();
 
-    _shadowMappingShader->SetMat4("lightSpaceMatrix", _lightSpaceMatrix);
-
-    glViewport(0, 0, (int)_shadowMappingFramebuffer->width(), (int)_shadowMappingFramebuffer->height());
+    // The shadow map holds another camera's cascades, none of them can be left as they are
+    auto &view = *_cascadeView;
+    if (_shadowMapCascadeView != &view) {
+        for (auto &&cache : view.caches) {
+            cache.liveIsStatic = false;
+        }
+        _shadowMapCascadeView = &view;
+    }
 
-    glClear(GL_DEPTH_BUFFER_BIT);
-    renderShadowMeshes(_queuedMeshes, *_shadowMappingShader.get());
+    // Each cascade renders to its quarter of the shadow map, only drawing the casters inside its projection
+    const int cascadeWidth = (int)_shadowMappingFramebuffer->width() / 2;
+    const int cascadeHeight = (int)_shadowMappingFramebuffer->height() / 2;
+    for (int i = 0; i < JLE_SHADOW_CASCADE_COUNT; i++) {
+        _shadowMappingCascade.set(i);
+        renderCachedShadowView(view.caches[i],
+                               view.cascades[i].matrix,
+                               *_shadowMappingFramebuffer,
+                               *view.staticFramebuffer,
+                               (i % 2) * cascadeWidth,
+                               (i / 2) * cascadeHeight,
+                               cascadeWidth,
+                               cascadeHeight);
+    }
 
     glEnable(GL_CULL_FACE);
 
@@ -488,71 +1415,371 @@ jle3DRenderer::renderDirectionalLight(const jleCamera &camera)
 }
 
 void
-jle3DRenderer::renderPointLights(const jleCamera &camera)
+jle3DRenderer::updateShadowCascades(const jleCamera &camera)
+{
+    // The camera's own view, or the one rendered the longest ago
+    _cascadeView = &_cascadeViews[0];
+    for (auto &&view : _cascadeViews) {
+        if (view.camera == &camera) {
+            _cascadeView = &view;
+            break;
+        }
+        if (_frame - view.renderedFrame > _frame - _cascadeView->renderedFrame) {
+            _cascadeView = &view;
+        }
+    }
+    auto &view = *_cascadeView;
+    if (view.camera != &camera) {
+        view.camera = &camera;
+        for (auto &&cascade : view.cascades) {
+            cascade.radius = 0.f;
+        }
+    }
+    view.renderedFrame = _frame;
+
+    if (!_useDirectionalLight) {
+        return;
+    }
+
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_updateShadowCascades)
+
+    if (!view.staticFramebuffer) {
+        view.staticFramebuffer =
+            std::make_unique<jleFramebufferShadowMap>(_shadowMappingFramebuffer->width(), _shadowMappingFramebuffer->height());
+    }
+
+    const bool perspective = camera.getProjectionType() == jleCameraProjection::Perspective;
+    const float cameraNear = camera.getNearPlane();
+    const float cameraFar = camera.getFarPlane();
+    const float shadowNear = perspective ? std::max(cameraNear, 0.001f) : std::max(cameraNear, -_directionalShadowDistance);
+    const float shadowFar = std::max(std::min(cameraFar, _directionalShadowDistance), shadowNear + 0.001f);
+
+    // Corners of the camera frustum in world space, the near plane's first
+    const auto inverseProjectionView = glm::inverse(camera.getProjectionViewMatrix());
+    std::array<glm::vec3, 8> frustumCorners;
+    for (int c = 0; c < 8; c++) {
+        const auto corner =
+            inverseProjectionView * glm::vec4{c & 1 ? 1.f : -1.f, c & 2 ? 1.f : -1.f, c & 4 ? 1.f : -1.f, 1.f};
+        frustumCorners[c] = glm::vec3{corner} / corner.w;
+    }
+
+    glm::vec3 lightDirection{0.f, 1.f, 0.f};
+    if (glm::length(_directionalLightRotation) > 0.0001f) {
+        lightDirection = glm::normalize(_directionalLightRotation);
+    }
+    const glm::vec3 up = std::abs(lightDirection.y) > 0.99f ? glm::vec3{0.f, 0.f, 1.f} : glm::vec3{0.f, 1.f, 0.f};
+    const auto lightView = glm::lookAt(glm::vec3{0.f}, -lightDirection, up);
+    const float cascadeResolution = _shadowMappingFramebuffer->width() / 2.f;
+
+    // A turned light moves all of the cascades
+    if (view.lightDirection != lightDirection) {
+        view.lightDirection = lightDirection;
+        for (auto &&cascade : view.cascades) {
+            cascade.radius = 0.f;
+        }
+    }
+
+    // Projections are this much larger than the slice's sphere, so the camera can move a bit before they do
+    constexpr float cascadeSlack = 1.25f;
+
+    float splitNear = shadowNear;
+    for (int i = 0; i < JLE_SHADOW_CASCADE_COUNT; i++) {
+        // Perspective splits blend logarithmic and uniform spacing, so that near cascades cover less
+        const float fraction = static_cast<float>(i + 1) / JLE_SHADOW_CASCADE_COUNT;
+        const float uniformSplit = shadowNear + (shadowFar - shadowNear) * fraction;
+        float splitFar = uniformSplit;
+        if (perspective) {
+            splitFar = glm::mix(uniformSplit, shadowNear * std::pow(shadowFar / shadowNear, fraction), 0.75f);
+        }
+
+        // View depth changes linearly between the camera frustum's near and far corners
+        const float nearT = (splitNear - cameraNear) / (cameraFar - cameraNear);
+        const float farT = (splitFar - cameraNear) / (cameraFar - cameraNear);
+        std::array<glm::vec3, 8> sliceCorners;
+        glm::vec3 center{0.f};
+        for (int c = 0; c < 4; c++) {
+            sliceCorners[c] = glm::mix(frustumCorners[c], frustumCorners[c + 4], nearT);
+            sliceCorners[c + 4] = glm::mix(frustumCorners[c], frustumCorners[c + 4], farT);
+            center += sliceCorners[c] + sliceCorners[c + 4];
+        }
+        center /= 8.f;
+
+        // A sphere around the slice keeps the same size however the camera is rotated
+        float sliceRadius = 0.f;
+        for (auto &&corner : sliceCorners) {
+            sliceRadius = std::max(sliceRadius, glm::distance(corner, center));
+        }
+        const float radius = std::ceil(sliceRadius * cascadeSlack * 16.f) / 16.f;
+        const glm::vec3 sliceCenter{lightView * glm::vec4{center, 1.f}};
+
+        // Kept while the slice's sphere is still inside the projection, also along the light
+        auto &cascade = view.cascades[i];
+        const auto offset = glm::abs(sliceCenter - cascade.lightSpaceCenter);
+        if (cascade.radius == radius && std::max(offset.x, std::max(offset.y, offset.z)) + sliceRadius <= radius) {
+            cascade.splitDepth = splitFar;
+            splitNear = splitFar;
+            continue;
+        }
+
+        const float texelSize = 2.f * radius / cascadeResolution;
+        glm::vec3 lightSpaceCenter = sliceCenter;
+        lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+        lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+
+        const auto projection = glm::ortho(lightSpaceCenter.x - radius,
+                                           lightSpaceCenter.x + radius,
+                                           lightSpaceCenter.y - radius,
+                                           lightSpaceCenter.y + radius,
+                                           -lightSpaceCenter.z - radius - _directionalShadowDistance,
+                                           -lightSpaceCenter.z + radius);
+
+        cascade = {projection * lightView, splitFar, lightSpaceCenter, radius};
+        splitNear = splitFar;
+    }
+}
+
+void
+jle3DRenderer::assignPointShadowSlots()
+{
+    JLE_SCOPE_PROFILE_CPU(jle3DRenderer_assignPointShadowSlots)
+
+    // Roughly the share of the screen a light's radius covers, the largest over the cameras that
+    // see it. Lights out of view of every camera have no visible shadows.
+    _pointShadowCandidates.clear();
+    for (uint32_t l = 0; l < _queuedLights.size(); l++) {
+        auto &light = _queuedLights[l];
+        light.shadowSlot = -1;
+
+        float coverage = -1.f;
+        for (auto &&view : _pointShadowViews) {
+            bool outside = false;
+            for (auto &&plane : view.planes) {
+                outside |= glm::dot(glm::vec3{plane}, light.position) + plane.w < -light.radius;
+            }
+            if (!outside) {
+                const float distance = std::max(glm::distance(view.position, light.position), 0.001f);
+                coverage = std::max(coverage, std::min(light.radius / distance, 1e6f));
+            }
+        }
+        if (coverage < 0.f) {
+            continue;
+        }
+
+        uint32_t bits;
+        std::memcpy(&bits, &coverage, sizeof(bits));
+        _pointShadowCandidates.push_back({bits, l});
+    }
+
+    const auto count = std::min<std::size_t>(_pointShadowCandidates.size(), JLE_POINT_SHADOW_SLOTS);
+    std::partial_sort(_pointShadowCandidates.begin(),
+                      _pointShadowCandidates.begin() + count,
+                      _pointShadowCandidates.end(),
+                      [](const jle3DRendererSortItem &a, const jle3DRendererSortItem &b) { return a.key > b.key; });
+    _pointShadowCandidates.resize(count);
+
+    // Slots follow their light when it moves less than a quarter of its radius per frame. A slot whose
+    // light is gone is kept for a while, so that a light briefly out of view doesn't render its faces again.
+    for (int s = 0; s < JLE_POINT_SHADOW_SLOTS; s++) {
+        auto &slot = _pointShadowSlots[s];
+        if (!slot.assigned) {
+            continue;
+        }
+
+        auto nearest = _pointShadowCandidates.end();
+        float nearestDistance = slot.radius * 0.25f;
+        for (auto it = _pointShadowCandidates.begin(); it != _pointShadowCandidates.end(); ++it) {
+            const auto &light = _queuedLights[it->index];
+            const float distance = glm::distance(light.position, slot.position);
+            if (light.shadowSlot < 0 && distance <= nearestDistance) {
+                nearest = it;
+                nearestDistance = distance;
+            }
+        }
+
+        if (nearest != _pointShadowCandidates.end()) {
+            _queuedLights[nearest->index].shadowSlot = s;
+            slot.lastUsedFrame = _frame;
+        } else if (_frame - slot.lastUsedFrame >= pointShadowSlotKeepFrames) {
+            slot.assigned = false;
+        }
+    }
+
+    uint32_t used = 0;
+    int freeSlot = 0;
+    for (auto &&candidate : _pointShadowCandidates) {
+        auto &light = _queuedLights[candidate.index];
+        if (light.shadowSlot < 0) {
+            while (freeSlot < JLE_POINT_SHADOW_SLOTS && _pointShadowSlots[freeSlot].assigned) {
+                freeSlot++;
+            }
+            if (freeSlot == JLE_POINT_SHADOW_SLOTS) {
+                continue;
+            }
+            light.shadowSlot = freeSlot;
+            _pointShadowSlots[freeSlot] = {true};
+            _pointShadowSlots[freeSlot].lastUsedFrame = _frame;
+        }
+
+        auto &slot = _pointShadowSlots[light.shadowSlot];
+        slot.position = light.position;
+        slot.radius = light.radius;
+        std::memcpy(&slot.coverage, &candidate.key, sizeof(slot.coverage));
+        used++;
+
+        // Until all faces have been rendered for this light, it is lit without shadows
+        if (slot.renderedFaces != 0x3F) {
+            light.shadowSlot = -1;
+        }
+    }
+
+    _stats.pointShadowLights = used;
+}
+
+void
+jle3DRenderer::renderPointLights()
 {
     JLE_SCOPE_PROFILE_CPU(jle3DRenderer_renderPointLights)
 
-    if (_queuedLights.empty()) {
+    _pointShadowFaces.clear();
+    for (int s = 0; s < JLE_POINT_SHADOW_SLOTS; s++) {
+        if (_pointShadowSlots[s].assigned && _pointShadowSlots[s].lastUsedFrame == _frame) {
+            for (int f = 0; f < 6; f++) {
+                _pointShadowFaces.push_back({s, f});
+            }
+        }
+    }
+    if (_pointShadowFaces.empty()) {
         return;
     }
 
+    auto faceOrder = [this](const jle3DRendererPointShadowFace &face) {
+        const auto &slot = _pointShadowSlots[face.slot];
+        return std::make_tuple((slot.renderedFaces >> face.face) & 1, slot.faceUpdatedFrame[face.face], -slot.coverage);
+    };
+    std::sort(_pointShadowFaces.begin(),
+              _pointShadowFaces.end(),
+              [&](const jle3DRendererPointShadowFace &a, const jle3DRendererPointShadowFace &b) {
+                  return faceOrder(a) < faceOrder(b);
+              });
+
     glCullFace(GL_BACK);
+    _shadowMappingPointShader->use();
 
-    float aspect = (float)_pointsShadowMappingFramebuffer->width() / (float)_pointsShadowMappingFramebuffer->height();
-    float nearP = 0.0f;
-    float farP = 500.0f;
-    glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), aspect, nearP, farP);
-
-    glm::vec3 lightPos = _queuedLights[0].position;
-
-    std::vector<glm::mat4> shadowTransforms;
-    shadowTransforms.push_back(shadowProj *
-                               glm::lookAt(lightPos, lightPos + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)));
-    shadowTransforms.push_back(shadowProj *
-                               glm::lookAt(lightPos, lightPos + glm::vec3(-1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)));
-    shadowTransforms.push_back(shadowProj *
-                               glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0, 0.0, 1.0)));
-    shadowTransforms.push_back(shadowProj *
-                               glm::lookAt(lightPos, lightPos + glm::vec3(0.0, -1.0, 0.0), glm::vec3(0.0, 0.0, -1.0)));
-    shadowTransforms.push_back(shadowProj *
-                               glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0)));
-    shadowTransforms.push_back(shadowProj *
-                               glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0)));
+    int budget = _pointShadowFaceBudget;
+    std::size_t f = 0;
+    for (; f < _pointShadowFaces.size() && budget > 0; f++) {
+        const auto &face = _pointShadowFaces[f];
+        auto &slot = _pointShadowSlots[face.slot];
+        const auto matrix = pointShadowFaceMatrix(slot.position, slot.radius, face.face);
+
+        _shadowMappingPointShader->SetVec3("lightPos", slot.position);
+        _shadowMappingPointShader->SetFloat("farPlane", slot.radius);
+        _shadowMappingPointShader->SetMat4("lightSpaceMatrix", matrix);
+
+        if (renderCachedShadowView(_pointShadowCaches[face.slot * 6 + face.face],
+                                   matrix,
+                                   *_pointShadowAtlasFramebuffer,
+                                   *_staticPointShadowAtlasFramebuffer,
+                                   face.face * JLE_POINT_SHADOW_FACE_SIZE,
+                                   face.slot * JLE_POINT_SHADOW_FACE_SIZE,
+                                   JLE_POINT_SHADOW_FACE_SIZE,
+                                   JLE_POINT_SHADOW_FACE_SIZE)) {
+            budget--;
+        }
 
-    _shadowMappingPointShader->use();
-    _shadowMappingPointShader->SetVec3("lightPos", lightPos);
-    _shadowMappingPointShader->SetFloat("farPlane", farP);
+        slot.renderedFaces |= 1 << face.face;
+        slot.faceUpdatedFrame[face.face] = _frame;
+    }
+
+    _stats.pointShadowFacesDelayed = static_cast<uint32_t>(_pointShadowFaces.size() - f);
+}
 
-    for (int i = 0; i < 6; i++) {
-        _shadowMappingPointShader->SetMat4("lightSpaceMatrix", shadowTransforms[i]);
-        _pointsShadowMappingFramebuffer->setRenderFace(i);
-        glViewport(0, 0, (int)_pointsShadowMappingFramebuffer->width(), (int)_pointsShadowMappingFramebuffer->height());
+bool
+jle3DRenderer::renderCachedShadowView(jle3DRendererShadowCache &cache,
+                                      const glm::mat4 &matrix,
+                                      jleFramebufferInterface &live,
+                                      jleFramebufferInterface &staticCache,
+                                      int x,
+                                      int y,
+                                      int width,
+                                      int height)
+{
+    if (!cache.valid || cache.matrix != matrix) {
+        staticCache.bind();
+        glViewport(x, y, width, height);
 
+        // Clearing ignores the viewport, the scissor keeps other views in the same map
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(x, y, width, height);
         glClear(GL_DEPTH_BUFFER_BIT);
-        renderShadowMeshes(_queuedMeshes, *_shadowMappingPointShader.get());
+        glDisable(GL_SCISSOR_TEST);
+
+        cullMeshBatches(matrix, jle3DRendererCullMode::StaticShadowCasters);
+        renderShadowMeshes();
+
+        cache = {matrix, true, false};
+        _stats.shadowViewsRedrawn++;
     }
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    cullMeshBatches(matrix, jle3DRendererCullMode::DynamicShadowCasters);
+    if (cache.liveIsStatic && _visibleBatches.empty()) {
+        _stats.shadowViewsSkipped++;
+        return false;
+    }
+
+    staticCache.blitDepthToOther(live, x, y, width, height);
+    live.bind();
+    glViewport(x, y, width, height);
+    renderShadowMeshes();
+    cache.liveIsStatic = _visibleBatches.empty();
+    return true;
 }
 
 void
-jle3DRenderer::renderShadowMeshes(const std::vector<jle3DRendererQueuedMesh> &meshes, jleShader &shader)
+jle3DRenderer::invalidateStaticShadows(const jle3DRendererQueuedMesh &caster)
 {
-    for (auto &&mesh : meshes) {
-        if (!mesh.castShadows) {
-            return;
+    // World space box around the caster's mesh, without a mesh all views are drawn again
+    glm::vec3 min{-FLT_MAX}, max{FLT_MAX};
+    if (caster.mesh) {
+        const auto &meshMin = caster.mesh->boundsMin();
+        const auto &meshMax = caster.mesh->boundsMax();
+        min = glm::vec3{FLT_MAX};
+        max = glm::vec3{-FLT_MAX};
+        for (int c = 0; c < 8; c++) {
+            const glm::vec3 corner{c & 1 ? meshMax.x : meshMin.x,
+                                   c & 2 ? meshMax.y : meshMin.y,
+                                   c & 4 ? meshMax.z : meshMin.z};
+            const glm::vec3 world{caster.transform * glm::vec4{corner, 1.f}};
+            min = glm::min(min, world);
+            max = glm::max(max, world);
         }
-        shader.SetMat4("model", mesh.transform);
-        glBindVertexArray(mesh.mesh->getVAO());
-        if (mesh.mesh->usesIndexing()) {
-            glDrawElements(GL_TRIANGLES, mesh.mesh->getTrianglesCount(), GL_UNSIGNED_INT, (void *)0);
-        } else {
-            glDrawArrays(GL_TRIANGLES, 0, mesh.mesh->getTrianglesCount());
+    }
+
+    auto invalidate = [&](jle3DRendererShadowCache &cache) {
+        if (cache.valid && boxInFrustum(frustumPlanes(cache.matrix), min, max)) {
+            cache.valid = false;
+        }
+    };
+    for (auto &&view : _cascadeViews) {
+        for (auto &&cache : view.caches) {
+            invalidate(cache);
         }
-        glBindVertexArray(0);
+    }
+    for (auto &&cache : _pointShadowCaches) {
+        invalidate(cache);
     }
 }
 
+void
+jle3DRenderer::renderShadowMeshes()
+{
+    resetStateCache();
+    for (auto &&visible : _visibleBatches) {
+        drawMeshBatch(visible);
+    }
+    bindVertexArray(0);
+}
+
 void
 jle3DRenderer::renderFullscreenQuad()
 {
@@ -593,13 +1820,6 @@ jle3DRenderer::setDirectionalLight(const glm::mat4 &view, const glm::vec3 &colou
 
     _directionalLightRotation = rotation * glm::vec3{0.f, 0.f, 1.f};
     _directionalLightColour = colour;
-
-    glm::mat4 lightProjection = glm::ortho(-100.0f, 100.0f, -100.0f, 100.0f, near_plane, far_plane);
-    glm::mat4 lightView =
-        glm::lookAt(glm::vec3(-2.0f, 4.0f, -1.0f), rotation * glm::vec3{0.f, -1.f, 0.f}, glm::vec3(0.0f, -1.0f, 0.0f));
-    lightView[1][1] *= -1.f;
-
-    _lightSpaceMatrix = lightProjection * view;
 }
 void
 jle3DRenderer::enableDirectionalLight()
@@ -644,8 +1864,6 @@ jle3DRenderer::renderLines(const jleCamera &camera, const std::vector<jle3DLineV
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     _linesShader->use();
-    _linesShader->SetMat4("projView", camera.getProjectionViewMatrix());
-    _linesShader->SetVec3("cameraPos", camera.getPosition());
 
     int linesRendered = 0;
 
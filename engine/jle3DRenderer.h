@@ -3,18 +3,31 @@
 #pragma once
 
 #include "jleCamera.h"
-#include "jleFramebufferShadowCubeMap.h"
 #include "jleFramebufferShadowMap.h"
 #include "jleMesh.h"
 #include "jleResourceRef.h"
 #include "jleShader.h"
 #include "jleSkybox.h"
 #include <glm/fwd.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #define JLE_LINE_DRAW_BATCH_SIZE 32768
 
+// Cascades of the directional light's shadow, laid out 2x2 in the shadow map
+#define JLE_SHADOW_CASCADE_COUNT 4
+
+// Cameras that keep their own cascades and cached static casters, such as the editor's and the game's
+#define JLE_SHADOW_CASCADE_VIEWS 2
+
+// Point lights with shadows share an atlas, with a row of six cube faces per light
+#define JLE_POINT_SHADOW_SLOTS 6
+#define JLE_POINT_SHADOW_FACE_SIZE 512
+
 class jleMaterial;
 
 class jle3DRenderer
@@ -26,11 +39,19 @@ public:
         std::shared_ptr<jleMaterial> material;
         int instanceId;
         bool castShadows;
+
+        // Transforms from the previous and the latest simulation step, that transform is blended between
+        glm::mat4 previousTransform;
+        glm::mat4 targetTransform;
     };
 
     struct jle3DRendererLight {
         glm::vec3 position;
         glm::vec3 color;
+        float radius;
+
+        // Row in the point shadow atlas, -1 if the light has no shadows this frame
+        int shadowSlot;
     };
 
     struct jle3DLineVertex
@@ -40,6 +61,47 @@ public:
         glm::vec3 attenuation; // {1.f, 0.f, 0.f} means no attenuation (constant)
     };
 
+    // Per-instance vertex attributes of mesh draws, model matrix at locations 5-8, picking colour at 9
+    struct jle3DRendererMeshInstance {
+        glm::mat4 transform;
+        glm::vec4 pickingColor;
+    };
+
+    // Meshes drawn in one instanced call, all sharing mesh, material and whether they cast shadows
+    struct jle3DRendererMeshBatch {
+        jleMesh *mesh;
+        jleMaterial *material;
+        bool castShadows;
+        int firstInstance;
+        int instanceCount;
+
+        // Sort key of the batch's state, see sortMeshBatches()
+        uint64_t stateKey;
+
+        // Instance positions' bounds, for ordering batches by their distance to the camera
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+
+    struct jle3DRendererStats {
+        // GL binds issued by the mesh passes, and the binds skipped since the state was already bound
+        uint32_t stateChanges;
+        uint32_t stateChangesSkipped;
+
+        // Mesh instances inside and outside the frustum, summed over the main, shadow and picking passes
+        uint32_t meshInstancesVisible;
+        uint32_t meshInstancesCulled;
+
+        // Shadow views (cascades and cube faces) whose static casters were drawn again, and views
+        // left as they were since neither the cached static casters nor any dynamic casters changed
+        uint32_t shadowViewsRedrawn;
+        uint32_t shadowViewsSkipped;
+
+        // Point lights with a slot in the shadow atlas, and their cube faces left for later frames
+        uint32_t pointShadowLights;
+        uint32_t pointShadowFacesDelayed;
+    };
+
     jle3DRenderer();
 
     virtual ~jle3DRenderer();
@@ -61,6 +123,32 @@ public:
                   int instanceId,
                   bool castShadows);
 
+    // Mesh drawn blended between its transforms from the previous and the latest simulation step
+    void sendMesh(std::shared_ptr<jleMesh> &mesh,
+                  std::shared_ptr<jleMaterial> &material,
+                  const glm::mat4 &transform,
+                  const glm::mat4 &previousTransform,
+                  int instanceId,
+                  bool castShadows);
+
+    // Mesh kept by the renderer until it is removed, instead of being sent every frame, so that
+    // meshes that don't move cost nothing per frame. The key is any address that stays the same
+    // while the proxy exists, usually the component that owns it. Sets the proxy if it exists.
+    void setMeshProxy(const void *key,
+                      const std::shared_ptr<jleMesh> &mesh,
+                      const std::shared_ptr<jleMaterial> &material,
+                      const glm::mat4 &transform,
+                      int instanceId,
+                      bool castShadows);
+
+    // Moves the proxy, blended from where it was at the start of the step when using a fixed timestep
+    void setMeshProxyTransform(const void *key, const glm::mat4 &transform);
+
+    void removeMeshProxy(const void *key);
+
+    // Blends the queued meshes' transforms, alpha 0 being the previous step and 1 the latest
+    void interpolateQueuedMeshes(float alpha);
+
     // Line strips will always connect each lines, from start to end.
     void sendLineStrip(const std::vector<jle3DLineVertex> &lines);
 
@@ -69,7 +157,8 @@ public:
 
     void sendLine(const jle3DLineVertex& from, const jle3DLineVertex& to);
 
-    void sendLight(const glm::vec3 &position, const glm::vec3 &color);
+    // The light fades out completely at the radius, and only lights the clusters its radius reaches
+    void sendLight(const glm::vec3 &position, const glm::vec3 &color, float radius);
 
     void enableDirectionalLight();
 
@@ -81,6 +170,13 @@ public:
 
     void clearBuffersForNextFrame();
 
+    // Called once per rendered frame before its render() calls, which may be several with more cameras.
+    // With a fixed timestep there can be any number of steps, and clearBuffersForNextFrame() calls, per frame.
+    void beginFrame();
+
+    // Counted since the last beginFrame(), over all of the frame's render() calls
+    [[nodiscard]] const jle3DRendererStats &stats() const;
+
 private:
     void renderFullscreenQuad();
 
@@ -97,9 +193,160 @@ private:
     jleResourceRef<jleShader> _debugDepthQuad;
     jleResourceRef<jleShader> _linesShader;
 
-    void renderMeshes(const jleCamera &camera, const std::vector<jle3DRendererQueuedMesh> &meshes);
+    // Uniforms of the mesh shader, looked up once instead of by name each frame
+    struct jle3DRendererMeshUniforms {
+        explicit jle3DRendererMeshUniforms(const jleShader &shader);
+
+        jleShaderUniform<int> shadowMap, shadowMapPoint, albedoTexture, normalTexture, skyboxTexture;
+        jleShaderUniform<int> clusterLightsTexture, clusterGridTexture, clusterIndicesTexture;
+        jleShaderUniform<bool> useAlbedoTexture, useNormalTexture;
+    };
+
+    jle3DRendererMeshUniforms _meshUniforms;
+
+    jleShaderUniform<int> _shadowMappingCascade;
+
+    // Per-frame data shared by the shaders through uniform buffers, laid out as their std140 blocks.
+    // vec3s are padded to vec4s, and the blocks are bound to their jleUniformBlockBinding.
+    struct jle3DRendererCameraBlock {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::mat4 projView;
+        glm::vec4 position;
+    };
+
+    struct jle3DRendererLightsBlock {
+        glm::vec4 directionalLightColour;
+        glm::vec4 directionalLightDir;
+
+        // Clusters per pixel in xy, and the scale and bias from view depth to slice in zw
+        glm::vec4 clusterScale;
+
+        // Cluster counts in xyz, w is 1 if the slices are spaced logarithmically
+        glm::ivec4 clusterDimensions;
+
+        int32_t useDirectionalLight;
+        int32_t useEnvironmentMapping;
+        int32_t padding[2];
+    };
+
+    struct jle3DRendererShadowsBlock {
+        glm::mat4 cascadeMatrices[JLE_SHADOW_CASCADE_COUNT];
+
+        // View depth where each cascade ends
+        glm::vec4 cascadeSplits;
+
+        // Size of a cube face in the point shadow atlas in texture coordinates in xy, and half
+        // a texel in the face's coordinates in zw
+        glm::vec4 pointShadowFace;
+    };
+
+    // Uploads the camera's block, done once per render and before picking
+    void uploadCameraBlock(const jleCamera &camera);
+
+    // Uploads the lights and shadows blocks and the light clusters, done once per render
+    void uploadLightingBlocks(const jleCamera &camera, int viewportWidth, int viewportHeight);
+
+    // Clustered forward lighting: the view is split into screen tiles and slices along the view depth,
+    // and each cluster gets a list of the point lights whose radius reaches it, so that fragments only
+    // iterate the lights in their cluster. GL ES 3.0 has no storage buffers, so the lights, the
+    // clusters and the light lists are uploaded as textures. Fills the block's cluster parameters.
+    void buildLightClusters(const jleCamera &camera,
+                            int viewportWidth,
+                            int viewportHeight,
+                            jle3DRendererLightsBlock &lights);
+
+    void uploadLightClusters();
+
+    void uploadUniformBlock(jleUniformBlockBinding binding, unsigned int buffer, const void *data, std::size_t size);
+
+    unsigned int _cameraUniformBuffer{}, _lightsUniformBuffer{}, _shadowsUniformBuffer{};
+
+    // Clusters a light reaches, inclusive
+    struct jle3DRendererLightClusterRange {
+        uint32_t light;
+        int minX, maxX, minY, maxY, minSlice, maxSlice;
+    };
+
+    std::vector<jle3DRendererLightClusterRange> _lightClusterRanges;
+
+    // Two texels per light, position and radius followed by colour
+    std::vector<glm::vec4> _clusterLightData;
+
+    // Offset and count of each cluster's light list in the indices
+    std::vector<glm::uvec2> _clusterGrid;
+    std::vector<uint32_t> _clusterLightIndices;
+
+    unsigned int _clusterLightsTexture{}, _clusterGridTexture{}, _clusterIndicesTexture{};
+
+    void renderMeshes(const jleCamera &camera);
+
+    // Draws the batches left by the last cullMeshBatches() with the shadow shader in use
+    void renderShadowMeshes();
+
+    // Shadows of static casters are kept in a separate shadow map for each shadow view. Each frame
+    // the live view is restored from it and only the dynamic casters are drawn on top. The cache is
+    // drawn again when the view's projection changes, or after invalidateStaticShadows() for a caster in view.
+    struct jle3DRendererShadowCache {
+        glm::mat4 matrix;
+        bool valid;
+
+        // If the live view holds only the static casters, so that it can be left alone
+        // when there are no dynamic casters
+        bool liveIsStatic;
+    };
+
+    // Brings the live shadow view up to date, with the live and cache framebuffers set to the view.
+    // False if the live view was left as it was.
+    bool renderCachedShadowView(jle3DRendererShadowCache &cache,
+                                const glm::mat4 &matrix,
+                                jleFramebufferInterface &live,
+                                jleFramebufferInterface &staticCache,
+                                int x,
+                                int y,
+                                int width,
+                                int height);
+
+    // Called when a static shadow caster is added, removed, changed or starts moving. Only the cached
+    // views that the caster's bounds, at its current transform, overlap are drawn again.
+    void invalidateStaticShadows(const jle3DRendererQueuedMesh &caster);
+
+    // Groups the mesh proxies and queued meshes into instanced draws, and uploads the instance data
+    void prepareMeshBatches();
+
+    enum class jle3DRendererCullMode { Visible, StaticShadowCasters, DynamicShadowCasters };
+
+    // Fills the visible batches with the instances whose bounding spheres are inside the frustum
+    void cullMeshBatches(const glm::mat4 &viewProjection, jle3DRendererCullMode mode);
+
+    // Orders the visible batches of the main pass by 64 bit keys, most significant first:
+    // pass 2 | coarse depth 4 | shader 6 | textures 12 | material 10 | vertex array 10 | depth 20.
+    // State is grouped so that binds can be skipped, and drawn front to back within the same state,
+    // with the coarse depth keeping far away groups behind near ones for early depth rejection.
+    void sortMeshBatches(const jleCamera &camera);
+
+    // The state cache is only valid within a pass, since other renderers bind without going through it
+    void resetStateCache();
+
+    void bindVertexArray(unsigned int vertexArray);
+
+    void bindTexture2D(int unit, unsigned int texture);
+
+    // A batch's instances inside the frustum, either its whole range in the instance buffer, or
+    // the instances left after culling copied to the culled instance buffer
+    struct jle3DRendererVisibleBatch {
+        uint32_t batch;
+        unsigned int instanceBuffer;
+        int firstInstance;
+        int instanceCount;
+    };
+
+    // Draws the batch's mesh with the per-instance attributes pointing at its range of instances
+    void drawMeshBatch(const jle3DRendererVisibleBatch &visible);
+
+    // Orders the mesh proxies by material and mesh, so that proxies drawn in one instanced call are adjacent
+    void sortMeshProxies();
 
-    void renderShadowMeshes(const std::vector<jle3DRendererQueuedMesh> &meshes, jleShader &shader);
 
     void renderLines(const jleCamera &camera, const std::vector<jle3DLineVertex>& linesBatch);
 
@@ -107,6 +354,68 @@ private:
 
     std::vector<jle3DRendererQueuedMesh> _queuedMeshes;
 
+    struct jle3DRendererMeshProxyKey {
+        const void *key;
+
+        // If the proxy moved since the last clearBuffersForNextFrame()
+        bool moved;
+
+        // Static proxies have their shadows cached. Proxies start out dynamic, become static when
+        // they haven't moved for a while, and are dynamic again as soon as they move.
+        bool isStatic;
+        uint32_t lastMovedFrame;
+    };
+
+    // Retained meshes and their keys, at the same index in both
+    std::vector<jle3DRendererQueuedMesh> _meshProxies;
+    std::vector<jle3DRendererMeshProxyKey> _meshProxyKeys;
+    std::unordered_map<const void *, std::size_t> _meshProxyIndices;
+
+    // Only the proxies that moved need interpolating and settling after each step
+    std::vector<const void *> _movedMeshProxies;
+
+    // Proxies that aren't static yet
+    std::vector<const void *> _dynamicMeshProxies;
+
+    // Counts beginFrame() calls
+    uint32_t _frame{};
+
+    bool _meshProxiesNeedSort{false};
+
+    std::vector<jle3DRendererMeshInstance> _meshInstances;
+    std::vector<jle3DRendererMeshBatch> _meshBatches;
+    unsigned int _meshInstanceBuffer{};
+
+    // Instances' bounding spheres in world space, with an array per component so that four
+    // spheres are tested against a plane at once. Padded to a multiple of four.
+    std::vector<float> _instanceSphereX, _instanceSphereY, _instanceSphereZ, _instanceSphereRadius;
+    std::vector<uint8_t> _instanceVisible;
+    std::vector<uint8_t> _instanceStatic;
+
+    std::vector<jle3DRendererVisibleBatch> _visibleBatches;
+    std::vector<jle3DRendererMeshInstance> _culledInstances;
+    unsigned int _culledInstanceBuffer{};
+
+    // Set when any mesh was sent, moved or removed, so that unchanged frames reuse the uploaded instances
+    bool _meshBatchesDirty{true};
+
+    struct jle3DRendererSortItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<jle3DRendererSortItem> _meshDrawOrder;
+    std::vector<jle3DRendererSortItem> _meshDrawOrderScratch;
+
+    struct jle3DRendererStateCache {
+        unsigned int vertexArray;
+        unsigned int textures2D[4];
+    };
+
+    jle3DRendererStateCache _stateCache{};
+
+    jle3DRendererStats _stats{};
+
     std::vector<std::vector<jle3DLineVertex>> _queuedLineStrips;
     std::vector<jle3DLineVertex> _queuedLines;
 
@@ -117,13 +426,93 @@ private:
     std::vector<jle3DRendererLight> _queuedLights;
 
     void renderDirectionalLight(const jleCamera &camera);
-    glm::mat4 _lightSpaceMatrix{};
-    float near_plane = -700.0f, far_plane = 700.f;
 
-    void renderPointLights(const jleCamera &camera);
+    // Splits the camera frustum up to the shadow distance into cascades, each with an orthographic
+    // projection around its slice. The projections keep their size when the camera turns, and move in
+    // whole texels, so that shadow edges don't shimmer. They have slack around the slice and stay
+    // where they are until the slice leaves it, so that their static casters stay cached meanwhile.
+    void updateShadowCascades(const jleCamera &camera);
+
+    struct jle3DRendererShadowCascade {
+        glm::mat4 matrix;
+        float splitDepth;
+
+        // Light space center and half size of the projection
+        glm::vec3 lightSpaceCenter;
+        float radius;
+    };
+
+    // Cascades and cached static casters of one camera, so that cameras rendered in the same frame
+    // don't evict each other's caches. The least recently rendered camera's view is reused.
+    struct jle3DRendererCascadeView {
+        const jleCamera *camera;
+        uint32_t renderedFrame;
+        glm::vec3 lightDirection;
+        std::array<jle3DRendererShadowCascade, JLE_SHADOW_CASCADE_COUNT> cascades;
+        std::array<jle3DRendererShadowCache, JLE_SHADOW_CASCADE_COUNT> caches;
+        std::unique_ptr<jleFramebufferShadowMap> staticFramebuffer;
+    };
+
+    std::array<jle3DRendererCascadeView, JLE_SHADOW_CASCADE_VIEWS> _cascadeViews{};
+
+    // View of the camera being rendered, and the view whose cascades the shadow map holds
+    jle3DRendererCascadeView *_cascadeView{};
+    const jle3DRendererCascadeView *_shadowMapCascadeView{};
+
+    // View depth up to which the directional light casts shadows, and how far behind the
+    // cascades towards the light that casters are still drawn
+    float _directionalShadowDistance{300.f};
+
+    // Gives the lights covering the most of the screen, in any of the cameras rendered the previous
+    // frame, a slot in the point shadow atlas. Lights keep their slot while they stay among them,
+    // matched by position from the previous frame.
+    void assignPointShadowSlots();
+
+    // Renders the cube faces of the lights with a slot, the faces not yet rendered for their light
+    // first and then the ones updated the longest ago, until the face budget is spent
+    void renderPointLights();
+
+    struct jle3DRendererPointShadowSlot {
+        bool assigned;
+        glm::vec3 position;
+        float radius;
+        float coverage;
+        uint32_t lastUsedFrame;
+
+        // Bit per face rendered since the slot was given to its light, shadows are used once all are
+        uint8_t renderedFaces;
+        std::array<uint32_t, 6> faceUpdatedFrame;
+    };
+
+    std::array<jle3DRendererPointShadowSlot, JLE_POINT_SHADOW_SLOTS> _pointShadowSlots{};
+
+    // Cube faces drawn per frame at most, faces left with no casters to draw are not counted
+    int _pointShadowFaceBudget{12};
+
+    struct jle3DRendererPointShadowFace {
+        int slot;
+        int face;
+    };
+
+    std::vector<jle3DRendererSortItem> _pointShadowCandidates;
+    std::vector<jle3DRendererPointShadowFace> _pointShadowFaces;
+
+    struct jle3DRendererPointShadowView {
+        std::array<glm::vec4, 6> planes;
+        glm::vec3 position;
+    };
+
+    // Cameras rendered since the last beginFrame()
+    std::vector<jle3DRendererPointShadowView> _pointShadowViews;
+    uint32_t _pointShadowAtlasFrame{};
 
     std::unique_ptr<jleFramebufferShadowMap> _shadowMappingFramebuffer{};
-    std::unique_ptr<jleFramebufferShadowCubeMap> _pointsShadowMappingFramebuffer{};
+    std::unique_ptr<jleFramebufferShadowMap> _pointShadowAtlasFramebuffer{};
+
+    // Depth of the static casters only, see jle3DRendererShadowCache. The cascades' are per camera.
+    std::unique_ptr<jleFramebufferShadowMap> _staticPointShadowAtlasFramebuffer{};
+
+    std::array<jle3DRendererShadowCache, JLE_POINT_SHADOW_SLOTS * 6> _pointShadowCaches{};
 
     bool _useDirectionalLight{false};
     bool _useEnvironmentMapping{true};
@@ -19,6 +19,8 @@ jleCamera::setPerspectiveProjection(
     float fov, uint32_t screenWidth, uint32_t screenHeight, float farPlane, float nearPlane)
 {
     _projectionType = jleCameraProjection::Perspective;
+    _nearPlane = nearPlane;
+    _farPlane = farPlane;
 
     _projectionMatrix =
         glm::perspective(glm::radians(fov), (float)screenWidth / (float)screenHeight, nearPlane, farPlane);
@@ -31,6 +33,8 @@ void
 jleCamera::setOrthographicProjection(uint32_t screenWidth, uint32_t screenHeight, float farPlane, float nearPlane)
 {
     _projectionType = jleCameraProjection::Orthographic;
+    _nearPlane = nearPlane;
+    _farPlane = farPlane;
     _projectionMatrix = glm::ortho(-((float)screenWidth / 2.0f),
                                    ((float)screenWidth / 2.0f),
                                    ((float)screenHeight / 2.0f),
@@ -86,6 +90,18 @@ jleCamera::getProjectionType() const
     return _projectionType;
 }
 
+float
+jleCamera::getNearPlane() const
+{
+    return _nearPlane;
+}
+
+float
+jleCamera::getFarPlane() const
+{
+    return _farPlane;
+}
+
 glm::mat4
 jleCameraSimpleFPVController::getLookAtViewMatrix() const
 {
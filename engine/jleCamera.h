@@ -77,8 +77,14 @@ struct jleCamera {
 
     [[nodiscard]] jleCameraProjection getProjectionType() const;
 
+    [[nodiscard]] float getNearPlane() const;
+
+    [[nodiscard]] float getFarPlane() const;
+
 private:
     jleCameraProjection _projectionType;
+    float _nearPlane{0.1f};
+    float _farPlane{1000.f};
     glm::mat4 _projectionMatrix{1.f};
     glm::mat4 _viewMatrix{1.f};
     glm::vec3 _backgroundColor{0.1f, 0.1f, 0.1f};
@@ -12,6 +12,8 @@ namespace cereal
 {
     class JSONOutputArchive;
     class JSONInputArchive;
+    class PortableBinaryOutputArchive;
+    class PortableBinaryInputArchive;
     class jleImGuiCerealArchive;
     class jleImGuiCerealArchiveInternal;
 }; // namespace cereal
@@ -21,11 +23,16 @@ namespace cereal
     extern template void object::serialize<cereal::jleImGuiCerealArchiveInternal>(                                     \
         cereal::jleImGuiCerealArchiveInternal &);                                                                      \
     extern template void object::serialize<cereal::JSONOutputArchive>(cereal::JSONOutputArchive &);                    \
-    extern template void object::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive &);
+    extern template void object::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive &);                      \
+    extern template void object::serialize<cereal::PortableBinaryOutputArchive>(                                       \
+        cereal::PortableBinaryOutputArchive &);                                                                        \
+    extern template void object::serialize<cereal::PortableBinaryInputArchive>(cereal::PortableBinaryInputArchive &);
 
 #define JLE_EXTERN_TEMPLATE_CEREAL_CPP(object)                                                                         \
     template void object::serialize<cereal::JSONOutputArchive>(cereal::JSONOutputArchive &);                           \
     template void object::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive &);                             \
+    template void object::serialize<cereal::PortableBinaryOutputArchive>(cereal::PortableBinaryOutputArchive &);       \
+    template void object::serialize<cereal::PortableBinaryInputArchive>(cereal::PortableBinaryInputArchive &);         \
     template void object::serialize<cereal::jleImGuiCerealArchive>(cereal::jleImGuiCerealArchive &);                   \
     template void object::serialize<cereal::jleImGuiCerealArchiveInternal>(cereal::jleImGuiCerealArchiveInternal &);
 
@@ -35,15 +42,22 @@ namespace cereal
 {
     class JSONOutputArchive;
     class JSONInputArchive;
+    class PortableBinaryOutputArchive;
+    class PortableBinaryInputArchive;
 }; // namespace cereal
 
 #define JLE_EXTERN_TEMPLATE_CEREAL_H(object)                                                                           \
     extern template void object::serialize<cereal::JSONOutputArchive>(cereal::JSONOutputArchive &);                    \
-    extern template void object::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive &);
+    extern template void object::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive &);                      \
+    extern template void object::serialize<cereal::PortableBinaryOutputArchive>(                                       \
+        cereal::PortableBinaryOutputArchive &);                                                                        \
+    extern template void object::serialize<cereal::PortableBinaryInputArchive>(cereal::PortableBinaryInputArchive &);
 
 #define JLE_EXTERN_TEMPLATE_CEREAL_CPP(object)                                                                         \
     template void object::serialize<cereal::JSONOutputArchive>(cereal::JSONOutputArchive &);                           \
-    template void object::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive &);
+    template void object::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive &);                             \
+    template void object::serialize<cereal::PortableBinaryOutputArchive>(cereal::PortableBinaryOutputArchive &);       \
+    template void object::serialize<cereal::PortableBinaryInputArchive>(cereal::PortableBinaryInputArchive &);
 
 #endif
 
@@ -6,6 +6,26 @@
 
 jleComponent::jleComponent(jleObject *owner, jleScene *scene) : _attachedToObject{owner}, _containedInScene{scene} {}
 
+jleComponent::jleComponent(const jleComponent &other)
+    : _attachedToObject{other._attachedToObject}, _containedInScene{other._containedInScene}
+{
+}
+
+jleComponent &
+jleComponent::operator=(const jleComponent &other)
+{
+    _attachedToObject = other._attachedToObject;
+    _containedInScene = other._containedInScene;
+    return *this;
+}
+
+jleComponent::~jleComponent()
+{
+    if (_pool) {
+        _pool->remove(this);
+    }
+}
+
 void
 jleComponent::destroy()
 {
@@ -3,6 +3,7 @@
 #ifndef JLE_COMPONENT
 #define JLE_COMPONENT
 
+#include "jleComponentPool.h"
 #include "jleTypeReflectionUtils.h"
 
 #include <string_view>
@@ -11,6 +12,7 @@
 #include "editor/jleImGuiCerealArchive.h"
 #endif
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 #include <cereal/types/base_class.hpp>
 #include <cereal/types/memory.hpp>
 
@@ -28,10 +30,32 @@ public:
 
     jleComponent(){};
 
-    virtual ~jleComponent() = default;
+    // Pool membership is never copied, a copy has to be added to a pool on its own
+    jleComponent(const jleComponent &other);
+
+    jleComponent &operator=(const jleComponent &other);
+
+    virtual ~jleComponent();
 
     [[nodiscard]] virtual std::shared_ptr<jleComponent> clone() const = 0;
 
+    // Clone into the contiguous storage of a component pool
+    [[nodiscard]] virtual std::shared_ptr<jleComponent> clonePooled(jleComponentPool &pool) const = 0;
+
+    // Copies the state of a component of the same type into this one, like clone() but
+    // without allocating. Used when a recycled component is reused for a duplicate.
+    virtual void copyFrom(const jleComponent &other) = 0;
+
+    // Restores a destroyed component to the state it was constructed with, so that
+    // addComponent() can reuse it. No constructor or destructor runs, so anything registered
+    // elsewhere must have been dropped in onDestroy(). Components that don't override this
+    // and return true are never reused by addComponent().
+    [[nodiscard]] virtual bool
+    resetForReuse()
+    {
+        return false;
+    }
+
     virtual void registerSelfLua(sol::table &self) = 0;
 
     template <class Archive>
@@ -50,11 +74,49 @@ public:
     {
     }
 
+    // Called when the object's transform, or a parent's, has changed since the last frame.
+    // See jleScene::notifyTransformChanges().
+    virtual void
+    onTransformChanged()
+    {
+    }
+
     virtual void
     update(float dt)
     {
     }
 
+    // Runs before update() each frame. When the scene uses component pools, the components
+    // of a type that overrides hasParallelUpdate() are spread over the job system's threads,
+    // so this may only touch the component's own state. Anything touching jleRendering,
+    // jlePhysics, Lua or other objects belongs in update(), which runs serially afterwards.
+    virtual void
+    parallelUpdate(float dt)
+    {
+    }
+
+    [[nodiscard]] virtual bool
+    hasParallelUpdate() const
+    {
+        return false;
+    }
+
+    // Seconds between updates, where update() and parallelUpdate() get the time since the
+    // previous one. 0 updates every frame. Components that only react to events or calls
+    // from other components return a negative interval, and are never updated.
+    [[nodiscard]] virtual float
+    tickInterval() const
+    {
+        return 0.f;
+    }
+
+    // Components that must run every frame even when their object sleeps, see jleObject::sleep()
+    [[nodiscard]] virtual bool
+    updatesWhileSleeping() const
+    {
+        return false;
+    }
+
     [[maybe_unused]] virtual void
     editorUpdate(float dt)
     {
@@ -79,6 +141,9 @@ public:
 
     virtual const std::string_view componentName() const = 0;
 
+    // Dense ID of this component's concrete type, see jleTypeReflectionUtils::componentTypeId()
+    [[nodiscard]] virtual uint32_t componentTypeId() const = 0;
+
     jleTransform &getTransform();
 
     template <typename T>
@@ -87,12 +152,39 @@ public:
 protected:
     friend class jleObject;
     friend class jleScene;
+    friend class jleComponentPool;
+
+    // resetForReuse() for components that hold nothing onDestroy() hasn't released,
+    // by assigning the component a newly constructed one
+    template <typename T>
+    bool
+    resetToConstructed()
+    {
+        *static_cast<T *>(this) = T{_attachedToObject, _containedInScene};
+        return true;
+    }
 
     // The object that owns this component
     jleObject *_attachedToObject{};
 
     // The scene in which this component's object lives
     jleScene *_containedInScene{};
+
+private:
+    // Whether the tick interval is up this frame, and the time to update with if it is.
+    // The parallel phase peeks, the tick is consumed by the serial update that follows.
+    bool peekTick(float dt, float &tickDt) const;
+
+    bool consumeTick(float dt, float &tickDt);
+
+    float _timeSinceTick{0.f};
+
+    // Set when the component is registered for batched updates in a scene's component pool
+    jleComponentPool *_pool{};
+    uint32_t _poolIndex{};
+
+    // Set when the component's memory lives in a component pool
+    bool _poolAllocated{false};
 };
 
 CEREAL_REGISTER_TYPE(jleComponent)
@@ -8,4 +8,23 @@ std::shared_ptr<T>
 jleComponent::addDependencyComponentInStart()
 {
     return _attachedToObject->addDependencyComponent<T>(this);
+}
+
+inline bool
+jleComponent::peekTick(float dt, float &tickDt) const
+{
+    const float interval = tickInterval();
+    tickDt = _timeSinceTick + dt;
+    return interval == 0.f || (interval > 0.f && tickDt >= interval);
+}
+
+inline bool
+jleComponent::consumeTick(float dt, float &tickDt)
+{
+    if (peekTick(dt, tickDt)) {
+        _timeSinceTick = 0.f;
+        return true;
+    }
+    _timeSinceTick = tickDt;
+    return false;
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+// Copyright (c) 2023. Johan Lind
+
+#include "jleComponentPool.h"
+#include "jleComponent.h"
+#include "jleJobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+std::size_t
+alignedBlockSize(std::size_t size)
+{
+    constexpr std::size_t alignment = alignof(std::max_align_t);
+    size = std::max(size, sizeof(void *));
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+} // namespace
+
+jleComponentPoolStorage::jleComponentPoolStorage(std::size_t blocksPerChunk) : _blocksPerChunk{blocksPerChunk} {}
+
+jleComponentPoolStorage::~jleComponentPoolStorage() = default;
+
+void *
+jleComponentPoolStorage::allocate(std::size_t size)
+{
+    const auto blockSize = alignedBlockSize(size);
+
+    // The block size is decided by the first allocation, which is always the same
+    // control block type for a given component. Anything else goes to the heap.
+    if (_blockSize == 0) {
+        _blockSize = blockSize;
+    }
+    if (blockSize != _blockSize) {
+        return ::operator new(size);
+    }
+
+    if (!_freeList) {
+        allocateChunk();
+    }
+
+    auto block = _freeList;
+    _freeList = block->next;
+    return block;
+}
+
+void
+jleComponentPoolStorage::deallocate(void *ptr, std::size_t size)
+{
+    if (alignedBlockSize(size) != _blockSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    auto block = static_cast<FreeBlock *>(ptr);
+    block->next = _freeList;
+    _freeList = block;
+}
+
+void
+jleComponentPoolStorage::allocateChunk()
+{
+    // operator new[] for std::byte returns memory aligned for any fundamental type
+    auto chunk = std::make_unique<std::byte[]>(_blockSize * _blocksPerChunk);
+
+    // Link the blocks in address order so consecutive allocations are contiguous
+    for (std::size_t i = _blocksPerChunk; i-- > 0;) {
+        auto block = reinterpret_cast<FreeBlock *>(chunk.get() + i * _blockSize);
+        block->next = _freeList;
+        _freeList = block;
+    }
+
+    _chunks.push_back(std::move(chunk));
+}
+
+jleComponentPool::jleComponentPool() : _storage{std::make_shared<jleComponentPoolStorage>()} {}
+
+jleComponentPool::~jleComponentPool()
+{
+    // Components may outlive the scene that owns the pool
+    for (auto &&component : _components) {
+        if (component) {
+            component->_pool = nullptr;
+        }
+    }
+}
+
+void
+jleComponentPool::add(jleComponent *component)
+{
+    if (component->_pool == this) {
+        return;
+    }
+    if (component->_pool) {
+        component->_pool->remove(component);
+    }
+
+    if (_components.empty()) {
+        _hasParallelUpdate = component->hasParallelUpdate();
+    }
+
+    component->_pool = this;
+    component->_poolIndex = static_cast<uint32_t>(_components.size());
+    _components.push_back(component);
+}
+
+void
+jleComponentPool::remove(jleComponent *component)
+{
+    if (component->_pool != this) {
+        return;
+    }
+
+    const auto index = component->_poolIndex;
+    component->_pool = nullptr;
+
+    if (_updating) {
+        // Keep indices stable while iterating, compact when the batch is done
+        _components[index] = nullptr;
+        _pendingCompaction = true;
+        return;
+    }
+
+    auto last = _components.back();
+    _components[index] = last;
+    last->_poolIndex = index;
+    _components.pop_back();
+}
+
+void
+jleComponentPool::update(float dt)
+{
+    _updating = true;
+
+    // Components added during the batch are updated from the next frame
+    const auto count = _components.size();
+    for (std::size_t i = 0; i < count; i++) {
+        float tickDt;
+        auto component = _components[i];
+        if (component && component->consumeTick(dt, tickDt)) {
+            component->update(tickDt);
+        }
+    }
+
+    _updating = false;
+
+    if (_pendingCompaction) {
+        compact();
+    }
+}
+
+void
+jleComponentPool::parallelUpdate(float dt, jleJobSystem &jobSystem)
+{
+    constexpr std::size_t batchSize = 64;
+
+    jobSystem.parallelFor(_components.size(), batchSize, [this, dt](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            // Runs before update() in the same frame, which consumes the tick
+            float tickDt;
+            if (_components[i]->peekTick(dt, tickDt)) {
+                _components[i]->parallelUpdate(tickDt);
+            }
+        }
+    });
+}
+
+bool
+jleComponentPool::hasParallelUpdate() const
+{
+    return _hasParallelUpdate;
+}
+
+const std::vector<jleComponent *> &
+jleComponentPool::components() const
+{
+    return _components;
+}
+
+void
+jleComponentPool::compact()
+{
+    _components.erase(std::remove(_components.begin(), _components.end(), nullptr), _components.end());
+    for (uint32_t i = 0; i < _components.size(); i++) {
+        _components[i]->_poolIndex = i;
+    }
+    _pendingCompaction = false;
+}
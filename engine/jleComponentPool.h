@@ -0,0 +1,151 @@
+// Copyright (c) 2023. Johan Lind
+
+#ifndef JLE_COMPONENTPOOL_H
+#define JLE_COMPONENTPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class jleComponent;
+class jleJobSystem;
+
+// Fixed-size block storage backing a single component type.
+// Blocks are carved out of large chunks that are never moved or freed while any
+// component allocated from them is alive, so component addresses stay stable.
+class jleComponentPoolStorage
+{
+public:
+    explicit jleComponentPoolStorage(std::size_t blocksPerChunk = 256);
+
+    ~jleComponentPoolStorage();
+
+    jleComponentPoolStorage(const jleComponentPoolStorage &) = delete;
+    jleComponentPoolStorage &operator=(const jleComponentPoolStorage &) = delete;
+
+    void *allocate(std::size_t size);
+
+    void deallocate(void *ptr, std::size_t size);
+
+private:
+    void allocateChunk();
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    std::size_t _blockSize{0};
+    std::size_t _blocksPerChunk;
+    FreeBlock *_freeList{nullptr};
+    std::vector<std::unique_ptr<std::byte[]>> _chunks;
+};
+
+// Allocator handed to std::allocate_shared so that both the component and its
+// control block end up in the pool. It keeps the storage alive until the last
+// component allocated from it is released, which may be after the scene is gone.
+template <typename T>
+class jleComponentPoolAllocator
+{
+public:
+    using value_type = T;
+
+    explicit jleComponentPoolAllocator(std::shared_ptr<jleComponentPoolStorage> storage) : _storage{std::move(storage)}
+    {
+    }
+
+    template <typename U>
+    jleComponentPoolAllocator(const jleComponentPoolAllocator<U> &other) : _storage{other._storage}
+    {
+    }
+
+    T *
+    allocate(std::size_t n)
+    {
+        return static_cast<T *>(_storage->allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T *ptr, std::size_t n)
+    {
+        _storage->deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool
+    operator==(const jleComponentPoolAllocator<U> &other) const
+    {
+        return _storage == other._storage;
+    }
+
+    template <typename U>
+    bool
+    operator!=(const jleComponentPoolAllocator<U> &other) const
+    {
+        return _storage != other._storage;
+    }
+
+private:
+    template <typename U>
+    friend class jleComponentPoolAllocator;
+
+    std::shared_ptr<jleComponentPoolStorage> _storage;
+};
+
+// Contiguous per-type component storage owned by a jleScene.
+// Components are allocated from the pool's storage and registered in a dense array
+// that the scene walks once per frame to update all components of this type in one batch.
+class jleComponentPool
+{
+public:
+    jleComponentPool();
+
+    ~jleComponentPool();
+
+    jleComponentPool(const jleComponentPool &) = delete;
+    jleComponentPool &operator=(const jleComponentPool &) = delete;
+
+    // Constructs a component of type T inside the pool's storage.
+    // The component is not updated until it is added with add().
+    template <typename T, typename... Args>
+    std::shared_ptr<T> create(Args &&...args);
+
+    // Registers the component for batched updates. The component does not
+    // need to be allocated from this pool's storage.
+    void add(jleComponent *component);
+
+    void remove(jleComponent *component);
+
+    void update(float dt);
+
+    // Runs parallelUpdate() for all components across the job system's threads
+    void parallelUpdate(float dt, jleJobSystem &jobSystem);
+
+    [[nodiscard]] bool hasParallelUpdate() const;
+
+    [[nodiscard]] const std::vector<jleComponent *> &components() const;
+
+private:
+    void compact();
+
+    std::shared_ptr<jleComponentPoolStorage> _storage;
+
+    std::vector<jleComponent *> _components;
+
+    // All components in a pool share a type, so this is decided by the first one added
+    bool _hasParallelUpdate{false};
+
+    bool _updating{false};
+    bool _pendingCompaction{false};
+};
+
+template <typename T, typename... Args>
+inline std::shared_ptr<T>
+jleComponentPool::create(Args &&...args)
+{
+    auto component = std::allocate_shared<T>(jleComponentPoolAllocator<T>{_storage}, std::forward<Args>(args)...);
+    component->_poolAllocated = true;
+    return component;
+}
+
+#endif // JLE_COMPONENTPOOL_H
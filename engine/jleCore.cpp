@@ -4,11 +4,14 @@
 #include "jleExplicitInclude.h"
 #include "jleFont.h"
 #include "jleInput.h"
+#include "jleJobSystem.h"
 #include "jleKeyboardInput.h"
 #include "jleMouseInput.h"
+#include "jleObjectTemplateCache.h"
 #include "jleProfiler.h"
 #include "jleRendering.h"
 #include "jleResource.h"
+#include "jleResourceConverter.h"
 #include "jleTimerManager.h"
 #include "jleWindow.h"
 
@@ -20,7 +23,11 @@
 #include <emscripten.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <thread>
 
 jleResourceRef<jleEngineSettings> g_CoreSettingsRef;
 
@@ -30,7 +37,8 @@ jleCore::jleCore()
                                                   std::make_shared<jleMouseInput>(_window))},
       _timerManager{std::make_unique<jleTimerManager>()},
       _rendering{std::make_shared<jleRendering>()},
-      _resources{std::make_unique<jleResources>()}, _soLoud{std::make_unique<SoLoud::Soloud>()}
+      _resources{std::make_unique<jleResources>()},
+      _objectTemplates{std::make_unique<jleObjectTemplateCache>()}, _soLoud{std::make_unique<SoLoud::Soloud>()}
 {
     PLOG_INFO << "Starting the core...";
 
@@ -42,17 +50,28 @@ jleCore::jleCore()
     }
     rmt_SetCurrentThreadName("Main Thread");
 
+    PLOG_INFO << "Starting the job system...";
+    _jobSystem = std::make_unique<jleJobSystem>();
+
+#ifdef BUILD_HEADLESS
+    PLOG_INFO << "Running headless, no sound engine is initialized";
+#else
     PLOG_INFO << "Initializing sound engine...";
     _soLoud->init();
+#endif
 }
 
 jleCore::~jleCore()
 {
+#ifndef BUILD_HEADLESS
     PLOG_INFO << "Destroying the sound engine...";
     _soLoud->deinit();
+#endif
 
     PLOG_INFO << "Destroying the remote profiling...";
+#ifndef BUILD_HEADLESS
     rmt_UnbindOpenGL();
+#endif
     rmt_DestroyGlobalInstance(_remotery);
 }
 
@@ -69,8 +88,12 @@ jleCore::run()
     g_CoreSettingsRef.path = jlePath{"GR:settings/enginesettings.es"};
     g_CoreSettingsRef.loadResource();
 
-    PLOG_INFO << "Initializing the window";
     _window->settings(settings().windowSettings);
+
+#ifdef BUILD_HEADLESS
+    PLOG_INFO << "Running headless, no window or rendering context is created";
+#else
+    PLOG_INFO << "Initializing the window";
     _window->initWindow(_rendering);
 
     PLOG_INFO << "Setting up rendering internals";
@@ -79,6 +102,13 @@ jleCore::run()
 
     PLOG_INFO << "Binding Remotery to OpenGL";
     rmt_BindOpenGL();
+#endif
+
+    if (_convertResourcesTo) {
+        PLOG_INFO << "Converting serialized resources";
+        jleResourceConverter{*_convertResourcesTo, _convertResourcesOutput}.convertAll();
+        return;
+    }
 
     PLOG_INFO << "Starting the game loop";
 
@@ -91,6 +121,13 @@ jleCore::run()
 #endif
 }
 
+void
+jleCore::convertResourcesOnRun(jleSerializationFormat format, const std::filesystem::path &outputDirectory)
+{
+    _convertResourcesTo = format;
+    _convertResourcesOutput = outputDirectory;
+}
+
 void
 jleCore::loop()
 {
@@ -110,14 +147,42 @@ jleCore::mainLoop()
 
     _timerManager->process();
 
-    input().mouse->updateDeltas();
-
-    update(deltaFrameTime());
+    _resources->processMainThreadTasks(g_CoreSettingsRef->mainThreadLoadBudgetMs);
+
+#ifdef BUILD_HEADLESS
+    // Without a window there is no input to read and nothing to render. With a fixed tick rate
+    // the loop sleeps until the next step is due, else it updates as fast as possible.
+    if (fixedTimestepEnabled()) {
+        updateFixedSteps();
+        const auto untilNextStep = fixedTimestep() - _fixedStepAccumulator;
+        std::this_thread::sleep_for(std::chrono::duration<float>(untilNextStep));
+    } else {
+        update(deltaFrameTime());
+    }
+#else
+    if (fixedTimestepEnabled()) {
+        updateFixedSteps();
+        _rendering->rendering3d().interpolateQueuedMeshes(_interpolationAlpha);
+    } else {
+        input().mouse->updateDeltas();
+        update(deltaFrameTime());
+        _interpolationAlpha = 1.f;
+    }
 
+    _rendering->rendering3d().beginFrame();
     render();
     _window->updateWindow();
 
-    running = !_window->windowShouldClose();
+    if (_window->windowShouldClose()) {
+        running = false;
+    }
+#endif
+}
+
+void
+jleCore::quit()
+{
+    running = false;
 }
 
 jleTimerManager &
@@ -126,15 +191,60 @@ jleCore::timerManager()
     return *_timerManager;
 }
 
+jleJobSystem &
+jleCore::jobSystem()
+{
+    return *_jobSystem;
+}
+
 void
 jleCore::refreshDeltaTimes()
 {
+#ifdef BUILD_HEADLESS
+    static const auto startTime = std::chrono::steady_clock::now();
+    _currentFrame = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+#else
     _currentFrame = _window->time();
+#endif
     _deltaTime = _currentFrame - _lastFrame;
     _lastFrame = _currentFrame;
     _fps = static_cast<int>(1.0 / _deltaTime);
 }
 
+bool
+jleCore::fixedTimestepEnabled() const
+{
+    return g_CoreSettingsRef->fixedTickRate > 0.f;
+}
+
+void
+jleCore::updateFixedSteps()
+{
+    const float step = fixedTimestep();
+    const int maxSteps = std::max(1, settings().maxFixedStepsPerFrame);
+
+    _fixedStepAccumulator += _deltaTime;
+
+    int steps = 0;
+    while (_fixedStepAccumulator >= step && steps < maxSteps) {
+#ifndef BUILD_HEADLESS
+        // Mouse movement between steps is given to the next step that runs
+        input().mouse->updateDeltas();
+#endif
+        update(step);
+        _fixedStepAccumulator -= step;
+        steps++;
+    }
+
+    // Drop the time that could not be caught up on, so that a long frame does not make
+    // the following frames spiral into running the maximum number of steps
+    if (_fixedStepAccumulator >= step) {
+        _fixedStepAccumulator = std::fmod(_fixedStepAccumulator, step);
+    }
+
+    _interpolationAlpha = _fixedStepAccumulator / step;
+}
+
 SoLoud::Soloud &
 jleCore::soLoud()
 {
@@ -147,6 +257,12 @@ jleCore::resources()
     return *_resources;
 }
 
+jleObjectTemplateCache &
+jleCore::objectTemplates()
+{
+    return *_objectTemplates;
+}
+
 jleWindow &
 jleCore::window()
 {
@@ -206,6 +322,21 @@ jleCore::lastFrameTime() const
     return _lastFrame;
 }
 
+float
+jleCore::fixedTimestep() const
+{
+    if (!fixedTimestepEnabled()) {
+        return 0.f;
+    }
+    return 1.f / g_CoreSettingsRef->fixedTickRate;
+}
+
+float
+jleCore::interpolationAlpha() const
+{
+    return _interpolationAlpha;
+}
+
 std::shared_ptr<jleEngineSettings>
 jleCore::settingsPtr()
 {
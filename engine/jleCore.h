@@ -5,8 +5,11 @@
 
 
 #include "jleEngineSettings.h"
+#include "jleSerializationFormat.h"
 #include "jleTexture.h"
+#include <filesystem>
 #include <memory>
+#include <optional>
 
 namespace SoLoud
 {
@@ -24,6 +27,8 @@ class jleQuadRendering;
 class jleTextRendering;
 class jleTimerManager;
 class jlePhysics;
+class jleJobSystem;
+class jleObjectTemplateCache;
 
 class jleCore;
 inline jleCore *gCore;
@@ -42,12 +47,23 @@ public:
 
     void run();
 
+    // Makes run() write all resources to the output directory, with the serialized ones
+    // converted to the format, and return instead of starting the game
+    void convertResourcesOnRun(jleSerializationFormat format, const std::filesystem::path &outputDirectory);
+
+    // Exits the main loop after the current frame
+    void quit();
+
     jleTimerManager &timerManager();
 
+    jleJobSystem &jobSystem();
+
     SoLoud::Soloud &soLoud();
 
     jleResources &resources();
 
+    jleObjectTemplateCache &objectTemplates();
+
     jleWindow &window();
 
     jleInput &input();
@@ -70,6 +86,13 @@ public:
 
     [[nodiscard]] float lastFrameTime() const;
 
+    // Delta time of each simulation step, or 0 if the simulation is updated once per frame
+    [[nodiscard]] float fixedTimestep() const;
+
+    // How far the current frame is between the two latest simulation steps, in [0, 1).
+    // Always 1 when the simulation is updated once per frame.
+    [[nodiscard]] float interpolationAlpha() const;
+
 private:
     void loop();
 
@@ -77,6 +100,9 @@ private:
 
     bool running{false};
 
+    std::optional<jleSerializationFormat> _convertResourcesTo;
+    std::filesystem::path _convertResourcesOutput;
+
     static void
     mainLoopEmscripten()
     {
@@ -105,8 +131,10 @@ private:
 
 protected:
     std::unique_ptr<jleResources> _resources;
+    std::unique_ptr<jleObjectTemplateCache> _objectTemplates;
     std::unique_ptr<jleFontData> _fontData;
     std::unique_ptr<jleTimerManager> _timerManager;
+    std::unique_ptr<jleJobSystem> _jobSystem;
     const std::shared_ptr<jleWindow> _window;
     const std::shared_ptr<jleInput> _input;
     const std::shared_ptr<jleRendering> _rendering;
@@ -116,10 +144,16 @@ protected:
 
     void refreshDeltaTimes();
 
+    [[nodiscard]] virtual bool fixedTimestepEnabled() const;
+
+    void updateFixedSteps();
+
     int _fps = 0;
     float _deltaTime = 0;
     float _currentFrame = 0;
     float _lastFrame = 0;
+    float _fixedStepAccumulator = 0;
+    float _interpolationAlpha = 1.f;
 };
 
 #endif // JLE_CORE_H
\ No newline at end of file
@@ -16,6 +16,21 @@ public:
 
     WindowSettings windowSettings;
 
+    // Simulation steps per second, where game and physics updates run with a fixed delta time
+    // and rendering is interpolated between steps. 0 updates once per rendered frame instead.
+    float fixedTickRate{0.f};
+
+    // Steps that may run in one frame to catch up, time beyond that is dropped
+    int maxFixedStepsPerFrame{5};
+
+    // Milliseconds per frame spent finishing work for resources loaded in the background,
+    // such as texture and mesh uploads. At least one piece of work always runs per frame.
+    float mainThreadLoadBudgetMs{4.f};
+
+    // Meshes keep a copy of their vertices after uploading them. Rigidbodies build their
+    // collision shapes from it, so it can only be turned off for games without mesh colliders.
+    bool keepMeshVertexData{true};
+
     SAVE_SHARED_THIS_SERIALIZED_JSON(jleSerializedResource)
 
     ~jleEngineSettings() override = default;
@@ -25,6 +40,14 @@ public:
     serialize(Archive &ar)
     {
         ar(CEREAL_NVP(windowSettings));
+
+        // Not present in settings saved before fixed timestep support
+        jleSerialization::optionalNvp(ar, "fixedTickRate", fixedTickRate);
+        jleSerialization::optionalNvp(ar, "maxFixedStepsPerFrame", maxFixedStepsPerFrame);
+
+        jleSerialization::optionalNvp(ar, "mainThreadLoadBudgetMs", mainThreadLoadBudgetMs);
+
+        jleSerialization::optionalNvp(ar, "keepMeshVertexData", keepMeshVertexData);
     }
 };
 
@@ -1,6 +1,7 @@
 // Copyright (c) 2023. Johan Lind
 
 #include "jleFileChangeNotifier.h"
+#include "jleObjectTemplateCache.h"
 #include "editor/jleEditorTextEdit.h"
 #include <editor/jleEditor.h>
 
@@ -64,6 +65,12 @@ jleFileChangeNotifier::notifyAdded(const jlePath &path)
 void
 jleFileChangeNotifier::notifyModification(const jlePath &path)
 {
+    if (path.getFileEnding() == "jobj") {
+        LOGI << "Object template modified: " << path.getVirtualPath() << " (recompiling on next use)";
+        gEngine->objectTemplates().invalidate(path);
+        return;
+    }
+
     if (gEngine->resources().isResourceLoaded(path)) {
         LOGI << "File modified: " << path.getVirtualPath() << " (reloading resource)";
         gEngine->resources().resource(path)->loadFromFile(path);
@@ -107,6 +107,8 @@ void jleFont::renderTargetDimensions(int width,
 }
 
 jleLoadFromFileSuccessCode jleFont::loadFromFile(const jlePath &path) {
+    // Glyphs are only loaded to be rendered
+#ifndef BUILD_HEADLESS
     if (!jleFontData::data) {
         throw std::runtime_error{"font not loaded"};
     }
@@ -118,6 +120,7 @@ jleLoadFromFileSuccessCode jleFont::loadFromFile(const jlePath &path) {
     }
 
     _fontLoaded = true;
+#endif
     return jleLoadFromFileSuccessCode::SUCCESS;
 }
 
@@ -31,6 +31,12 @@ public:
 
     jleLoadFromFileSuccessCode loadFromFile(const jlePath &path) override;
 
+    [[nodiscard]] bool
+    requiresMainThreadLoad() const override
+    {
+        return true;
+    }
+
     // TODO: Move rendering to Text Rendering engine subsystem
     // TODO: Add scale as param
     void renderText(const std::string &text,
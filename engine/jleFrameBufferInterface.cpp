@@ -38,6 +38,16 @@ jleFramebufferInterface::blitToOther(jleFramebufferInterface &framebuffer, bool
         0, 0, (int)width(), (int)height(), 0, 0, (int)framebuffer.width(), (int)framebuffer.height(), flag, GL_LINEAR);
 }
 
+void
+jleFramebufferInterface::blitDepthToOther(jleFramebufferInterface &framebuffer, int x, int y, int width, int height)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer._framebuffer);
+
+    // Depth can only be blitted without filtering
+    glBlitFramebuffer(x, y, x + width, y + height, x, y, x + width, y + height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+}
+
 void
 jleFramebufferInterface::bind()
 {
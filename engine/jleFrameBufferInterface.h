@@ -15,6 +15,9 @@ public:
     // Copy framebuffer content from this framebuffer to another
     void blitToOther(jleFramebufferInterface &framebuffer, bool includeDepth = false);
 
+    // Copy the depth in a rectangle to the same rectangle in another framebuffer with the same depth format
+    void blitDepthToOther(jleFramebufferInterface &framebuffer, int x, int y, int width, int height);
+
     virtual void resize(unsigned int width, unsigned int height) = 0;
 
     // Specifies which axis to be fixed, and the other scales depending on window aspect ratio
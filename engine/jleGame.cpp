@@ -7,6 +7,7 @@ void
 jleGame::updateActiveScenes(float dt)
 {
     JLE_SCOPE_PROFILE_CPU(jleGame_updateActiveScenes)
+
     for (int i = _activeScenes.size() - 1; i >= 0; i--) {
         if (_activeScenes[i]->bPendingSceneDestruction) {
             _activeScenes.erase(_activeScenes.begin() + i);
@@ -29,4 +30,77 @@ jleGame::jleGame()
 {
 }
 
+jleGame::~jleGame()
+{
+    // Scene loads not yet started are dropped, their futures are left with a broken promise
+    {
+        std::lock_guard lock{_sceneLoadsMutex};
+        _stopSceneLoader = true;
+    }
+    _sceneLoadsCondition.notify_one();
+    if (_sceneLoader.joinable()) {
+        _sceneLoader.join();
+    }
+}
+
+void
+jleGame::sceneLoaderLoop()
+{
+    while (true) {
+        std::function<void()> load;
+        {
+            std::unique_lock lock{_sceneLoadsMutex};
+            _sceneLoadsCondition.wait(lock, [this]() { return _stopSceneLoader || !_sceneLoads.empty(); });
+            if (_stopSceneLoader) {
+                return;
+            }
+            load = std::move(_sceneLoads.front());
+            _sceneLoads.pop_front();
+        }
+        load();
+    }
+}
+
+void
+jleGame::activateScene(const std::shared_ptr<jleScene> &scene)
+{
+    auto it = std::find(_activeScenes.begin(), _activeScenes.end(), scene);
+    if (it == _activeScenes.end()) {
+        _activeScenes.push_back(scene);
+        scene->onSceneCreation();
+        scene->startObjects();
+    } else {
+        LOG_WARNING << "Loaded scene is already loaded";
+    }
+}
+
+std::shared_future<std::shared_ptr<jleScene>>
+jleGame::loadSceneAsync(const jlePath &scenePath)
+{
+    auto promise = std::make_shared<std::promise<std::shared_ptr<jleScene>>>();
+    std::shared_future<std::shared_ptr<jleScene>> future = promise->get_future().share();
+
+    std::weak_ptr<bool> lifetime = _lifetimeToken;
+    {
+        std::lock_guard lock{_sceneLoadsMutex};
+        _sceneLoads.push_back([this, scenePath, promise, lifetime]() {
+            std::shared_ptr<jleScene> scene = gCore->resources().loadResourceFromFile<jleScene>(scenePath, true);
+
+            // Queued after the scene's own main thread work, so it is activated once that is done
+            gCore->resources().runOnMainThread([this, scene, promise, lifetime]() {
+                if (scene && !lifetime.expired()) {
+                    activateScene(scene);
+                }
+                promise->set_value(scene);
+            });
+        });
+    }
+    _sceneLoadsCondition.notify_one();
+
+    if (!_sceneLoader.joinable()) {
+        _sceneLoader = std::thread{&jleGame::sceneLoaderLoop, this};
+    }
+    return future;
+}
+
 
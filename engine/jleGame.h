@@ -2,7 +2,13 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "jleCamera.h"
@@ -12,6 +18,7 @@
 #include "jleScene.h"
 
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 
 #ifdef BUILD_EDITOR
 #include "editor/jleImGuiCerealArchive.h"
@@ -25,7 +32,7 @@ class jleGame
 public:
     jleGame();
 
-    virtual ~jleGame() = default;
+    virtual ~jleGame();
 
     virtual void
     update(float dt)
@@ -58,24 +65,38 @@ public:
     {
         std::shared_ptr<jleScene> scene = gCore->resources().loadResourceFromFile<jleScene>(scenePath, true);
         if (scene) {
-            auto it = std::find(_activeScenes.begin(), _activeScenes.end(), scene);
-            if (it == _activeScenes.end()) {
-                _activeScenes.push_back(scene);
-                scene->onSceneCreation();
-                scene->startObjects();
-            } else {
-                LOG_WARNING << "Loaded scene is already loaded";
-            }
+            activateScene(scene);
         }
 
         return scene;
     }
 
+    // Loads a scene on a background thread while the game keeps running. Work that needs the
+    // main thread, such as GPU uploads, is spread over the following frames, after which the
+    // scene becomes active and the future is ready. Scenes load one at a time, in the order asked for.
+    std::shared_future<std::shared_ptr<jleScene>> loadSceneAsync(const jlePath &scenePath);
+
     std::vector<std::shared_ptr<jleScene>> &activeScenesRef();
 
     jleCamera mainCamera{jleCameraProjection::Orthographic};
 
 
 protected:
+    void activateScene(const std::shared_ptr<jleScene> &scene);
+
     std::vector<std::shared_ptr<jleScene>> _activeScenes;
+
+private:
+    void sceneLoaderLoop();
+
+    // Started by the first loadSceneAsync()
+    std::thread _sceneLoader;
+    std::mutex _sceneLoadsMutex;
+    std::condition_variable _sceneLoadsCondition;
+    std::deque<std::function<void()>> _sceneLoads;
+    bool _stopSceneLoader{false};
+
+    // Main thread tasks queued by scene loads hold a weak reference to this,
+    // so that they do nothing if the game is gone when they run
+    std::shared_ptr<bool> _lifetimeToken{std::make_shared<bool>(true)};
 };
\ No newline at end of file
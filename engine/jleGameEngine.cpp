@@ -170,6 +170,7 @@ jleGameEngine::startRmlUi()
 void
 jleGameEngine::start()
 {
+#ifndef BUILD_HEADLESS
     constexpr int initialScreenX = 1024;
     constexpr int initialScreenY = 1024;
     mainScreenFramebuffer = std::make_shared<jleFramebufferScreen>(initialScreenX, initialScreenY);
@@ -177,14 +178,17 @@ jleGameEngine::start()
     const auto &mouse = gCore->input().mouse;
     mouse->setPixelatedScreenSize(initialScreenX, initialScreenY);
     mouse->setScreenSize(initialScreenX, initialScreenY);
+#endif
 
     luaEnvironment()->loadScript("ER:/scripts/engine.lua");
 
+#ifndef BUILD_HEADLESS
     startRmlUi();
 
     _fullscreen_renderer = std::make_unique<jleFullscreenRendering>();
+#endif
 
-#ifndef BUILD_EDITOR
+#if !defined(BUILD_EDITOR) && !defined(BUILD_HEADLESS)
     window().addWindowResizeCallback(
         std::bind(&jleGameEngine::gameWindowResizedEvent, this, std::placeholders::_1, std::placeholders::_2));
 #endif
@@ -246,6 +250,13 @@ jleGameEngine::update(float dt)
 {
     JLE_SCOPE_PROFILE_CPU(jleGameEngine_Update)
     if (!gameHalted && game) {
+#ifndef BUILD_HEADLESS
+        if (fixedTimestepEnabled()) {
+            // What is sent for rendering is kept until the next step replaces it,
+            // so that frames rendered in between steps draw the same, interpolated, scene
+            rendering().clearBuffersForNextFrame();
+        }
+#endif
         {
             JLE_SCOPE_PROFILE_CPU(jleGameEngine_updateGame)
             game->update(dt);
@@ -254,11 +265,17 @@ jleGameEngine::update(float dt)
             JLE_SCOPE_PROFILE_CPU(jleGameEngine_updateActiveScenes)
             game->updateActiveScenes(dt);
         }
+#ifndef BUILD_HEADLESS
         {
             JLE_SCOPE_PROFILE_CPU(RmlUi)
             context->Update();
         }
-        physics().step(dt);
+#endif
+        physics().step(dt, fixedTimestepEnabled());
+
+        for (auto &&scene : game->activeScenesRef()) {
+            scene->notifyTransformChanges();
+        }
     }
 }
 
@@ -276,7 +293,9 @@ jleGameEngine::render()
         }
 
         rendering().renderMSAA(*mainScreenFramebuffer.get(), msaa, gameRef().mainCamera);
-        rendering().clearBuffersForNextFrame();
+        if (!fixedTimestepEnabled()) {
+            rendering().clearBuffersForNextFrame();
+        }
         _fullscreen_renderer->renderFramebufferFullscreen(*mainScreenFramebuffer, window().width(), window().height());
     }
 }
@@ -285,7 +304,9 @@ void
 jleGameEngine::exiting()
 {
     killGame();
+#ifndef BUILD_HEADLESS
     killRmlUi();
+#endif
 }
 
 void
@@ -0,0 +1,201 @@
+// Copyright (c) 2023. Johan Lind
+
+#include "jleJobSystem.h"
+
+#include "Remotery/Remotery.h"
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+// Which queue the current thread owns, 0 for threads that are not workers
+thread_local const jleJobSystem *tJobSystem = nullptr;
+thread_local unsigned int tQueueIndex = 0;
+} // namespace
+
+jleJobSystem::jleJobSystem(unsigned int workerCount)
+{
+    _queues.reserve(workerCount + 1);
+    for (unsigned int i = 0; i < workerCount + 1; i++) {
+        _queues.push_back(std::make_unique<jleJobQueue>());
+    }
+
+    _workers.reserve(workerCount);
+    for (unsigned int i = 1; i <= workerCount; i++) {
+        _workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    PLOG_INFO << "Job system started with " << workerCount << " worker threads";
+}
+
+jleJobSystem::~jleJobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock{_sleepMutex};
+        _running = false;
+    }
+    _sleepCondition.notify_all();
+
+    for (auto &&worker : _workers) {
+        worker.join();
+    }
+}
+
+unsigned int
+jleJobSystem::defaultWorkerCount()
+{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    return 0;
+#else
+    const auto hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+#endif
+}
+
+unsigned int
+jleJobSystem::workerCount() const
+{
+    return static_cast<unsigned int>(_workers.size());
+}
+
+void
+jleJobSystem::submit(std::function<void()> job, jleJobCounter *counter)
+{
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto &queue = *_queues[currentQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.jobs.push_back(jleJob{std::move(job), counter});
+    }
+
+    _queuedJobs.fetch_add(1, std::memory_order_release);
+    {
+        // Taking the lock orders the notification after a worker checking the predicate
+        std::lock_guard<std::mutex> lock{_sleepMutex};
+    }
+    _sleepCondition.notify_one();
+}
+
+void
+jleJobSystem::wait(jleJobCounter &counter)
+{
+    const auto queueIndex = currentQueueIndex();
+    while (!counter.done()) {
+        if (!tryRunJob(queueIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void
+jleJobSystem::parallelFor(std::size_t count,
+                          std::size_t batchSize,
+                          const std::function<void(std::size_t, std::size_t)> &fn)
+{
+    if (count == 0) {
+        return;
+    }
+
+    batchSize = std::max<std::size_t>(batchSize, 1);
+
+    // Not worth scheduling anything if there's only a single batch, or nobody to share it with
+    if (count <= batchSize || _workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    jleJobCounter counter;
+    for (std::size_t begin = 0; begin < count; begin += batchSize) {
+        const auto end = std::min(begin + batchSize, count);
+        submit([&fn, begin, end]() { fn(begin, end); }, &counter);
+    }
+
+    wait(counter);
+}
+
+void
+jleJobSystem::workerLoop(unsigned int queueIndex)
+{
+    tJobSystem = this;
+    tQueueIndex = queueIndex;
+
+    const auto threadName = "Job Worker " + std::to_string(queueIndex);
+    rmt_SetCurrentThreadName(threadName.c_str());
+
+    while (_running) {
+        if (tryRunJob(queueIndex)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{_sleepMutex};
+        _sleepCondition.wait(lock, [this]() { return !_running || _queuedJobs.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+bool
+jleJobSystem::tryRunJob(unsigned int queueIndex)
+{
+    jleJob job;
+    if (!tryPop(queueIndex, job) && !trySteal(queueIndex, job)) {
+        return false;
+    }
+
+    _queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+    try {
+        job.function();
+    } catch (std::exception &e) {
+        LOGE << "Job threw an exception: " << e.what();
+    }
+
+    if (job.counter) {
+        job.counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    return true;
+}
+
+bool
+jleJobSystem::tryPop(unsigned int queueIndex, jleJob &outJob)
+{
+    auto &queue = *_queues[queueIndex];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.jobs.empty()) {
+        return false;
+    }
+
+    // Newest job first, its data is most likely still in cache
+    outJob = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool
+jleJobSystem::trySteal(unsigned int queueIndex, jleJob &outJob)
+{
+    const auto queueCount = static_cast<unsigned int>(_queues.size());
+    for (unsigned int i = 1; i < queueCount; i++) {
+        auto &queue = *_queues[(queueIndex + i) % queueCount];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (queue.jobs.empty()) {
+            continue;
+        }
+
+        // Steal the oldest job, which tends to be the largest remaining piece of work
+        outJob = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
+
+unsigned int
+jleJobSystem::currentQueueIndex() const
+{
+    return tJobSystem == this ? tQueueIndex : 0;
+}
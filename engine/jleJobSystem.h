@@ -0,0 +1,87 @@
+// Copyright (c) 2023. Johan Lind
+
+#ifndef JLE_JOBSYSTEM_H
+#define JLE_JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tracks a group of submitted jobs, wait on it with jleJobSystem::wait()
+struct jleJobCounter {
+    std::atomic<int> pending{0};
+
+    [[nodiscard]] bool
+    done() const
+    {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+};
+
+// Work-stealing job scheduler. Each thread pushes and pops jobs at the back of its
+// own queue, and idle threads steal from the front of other threads' queues.
+// The thread calling wait() keeps running jobs until the counter reaches zero,
+// so the main thread is never idle while waiting on its own work.
+class jleJobSystem
+{
+public:
+    // Defaults to one worker per hardware thread, minus the main thread
+    explicit jleJobSystem(unsigned int workerCount = defaultWorkerCount());
+
+    ~jleJobSystem();
+
+    jleJobSystem(const jleJobSystem &) = delete;
+    jleJobSystem &operator=(const jleJobSystem &) = delete;
+
+    void submit(std::function<void()> job, jleJobCounter *counter = nullptr);
+
+    // Runs pending jobs on the calling thread until all jobs tracked by the counter are done
+    void wait(jleJobCounter &counter);
+
+    // Splits [0, count) into batches of at most batchSize and runs them across all threads.
+    // Blocks until every batch is done. The function receives the [begin, end) range of a batch.
+    void parallelFor(std::size_t count, std::size_t batchSize, const std::function<void(std::size_t, std::size_t)> &fn);
+
+    [[nodiscard]] unsigned int workerCount() const;
+
+    static unsigned int defaultWorkerCount();
+
+private:
+    struct jleJob {
+        std::function<void()> function;
+        jleJobCounter *counter;
+    };
+
+    struct jleJobQueue {
+        std::mutex mutex;
+        std::deque<jleJob> jobs;
+    };
+
+    void workerLoop(unsigned int queueIndex);
+
+    bool tryRunJob(unsigned int queueIndex);
+
+    bool tryPop(unsigned int queueIndex, jleJob &outJob);
+
+    bool trySteal(unsigned int queueIndex, jleJob &outJob);
+
+    unsigned int currentQueueIndex() const;
+
+    // Queue 0 is shared by all threads that are not workers, such as the main thread
+    std::vector<std::unique_ptr<jleJobQueue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::atomic<bool> _running{true};
+    std::atomic<int> _queuedJobs{0};
+
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+};
+
+#endif // JLE_JOBSYSTEM_H
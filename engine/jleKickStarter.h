@@ -10,20 +10,29 @@
 #include <plog/Init.h>
 #include "jleDynamicLogAppender.h"
 
+#include <cstring>
+#include <filesystem>
+#include <optional>
+
 template <typename T>
-void kickStartGame() {
+void kickStartGame(std::optional<jleSerializationFormat> convertResourcesTo = std::nullopt,
+                   const std::filesystem::path &convertResourcesOutput = {}) {
     LOG_VERBOSE << "Kickstarting the game";
     static_assert(std::is_base_of<jleGame, T>::value,
                   "T must derive from jleGame");
 
     auto gameEngine = std::make_unique<jleGameEngine>();
     gameEngine->setGame<T>();
+    if (convertResourcesTo) {
+        gameEngine->convertResourcesOnRun(*convertResourcesTo, convertResourcesOutput);
+    }
     gameEngine->run();
 }
 
 #ifdef BUILD_EDITOR
 template <typename T>
-void kickStartGameInEditor() {
+void kickStartGameInEditor(std::optional<jleSerializationFormat> convertResourcesTo = std::nullopt,
+                           const std::filesystem::path &convertResourcesOutput = {}) {
     LOG_VERBOSE << "Kickstarting the editor";
     static_assert(std::is_base_of<jleGame, T>::value,
                   "T must derive from jleGame");
@@ -31,12 +40,18 @@ void kickStartGameInEditor() {
     auto gameEngineInEditor =
         std::make_unique<jleEditor>();
     gameEngineInEditor->setGame<T>();
+    if (convertResourcesTo) {
+        gameEngineInEditor->convertResourcesOnRun(*convertResourcesTo, convertResourcesOutput);
+    }
     gameEngineInEditor->run();
 }
 #endif // BUILD_EDITOR
 
+// Passing "--convert-resources binary <output directory>" (or "json") writes the resources to
+// the output directory with the serialized ones converted to that format, and exits instead
+// of running the game. The resources that are read are left as they are.
 template <typename T>
-void kickStart() {
+void kickStart(int argc = 0, char *argv[] = nullptr) {
     static_assert(std::is_base_of<jleGame, T>::value,
                   "T must derive from jleGame");
 
@@ -49,9 +64,29 @@ void kickStart() {
         consoleAppender; // Log to command window
     plog::init<0>(plog::verbose, &fileAppender).addAppender(&consoleAppender).addAppender(&dynamicAppender());
 
+    std::optional<jleSerializationFormat> convertResourcesTo;
+    std::filesystem::path convertResourcesOutput;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--convert-resources") == 0) {
+            if (i + 2 >= argc) {
+                LOGE << "Usage: --convert-resources binary|json <output directory>";
+                return;
+            }
+            convertResourcesOutput = argv[i + 2];
+            if (std::strcmp(argv[i + 1], "binary") == 0) {
+                convertResourcesTo = jleSerializationFormat::Binary;
+            } else if (std::strcmp(argv[i + 1], "json") == 0) {
+                convertResourcesTo = jleSerializationFormat::Json;
+            } else {
+                LOGE << "Unknown resource format: " << argv[i + 1];
+                return;
+            }
+        }
+    }
+
 #ifdef BUILD_EDITOR
-    kickStartGameInEditor<T>();
+    kickStartGameInEditor<T>(convertResourcesTo, convertResourcesOutput);
 #else
-    kickStartGame<T>();
+    kickStartGame<T>(convertResourcesTo, convertResourcesOutput);
 #endif
 }
@@ -85,6 +85,12 @@ jleLuaEnvironment::setupLua(sol::state &lua)
         [](jleObject &object) { return object.duplicate().get(); },
         "destroy",
         &jleObject::destroyObject,
+        "sleep",
+        &jleObject::sleep,
+        "wake",
+        &jleObject::wake,
+        "isSleeping",
+        &jleObject::isSleeping,
         "pendingKill",
         sol::readonly(&jleObject::_pendingKill),
         "isStarted",
@@ -99,10 +105,16 @@ jleLuaEnvironment::setupLua(sol::state &lua)
                                &jleScene::sceneName,
                                "spawnObject",
                                &jleScene::spawnObjectWithName,
+                               "spawnTemplateObject",
+                               [](jleScene &scene, const std::string &path) {
+                                   return scene.spawnTemplateObject(jlePath{path});
+                               },
                                "destroy",
                                &jleScene::destroyScene,
                                "objects",
-                               &jleScene::sceneObjects);
+                               &jleScene::sceneObjects,
+                               "findObjectByInstanceId",
+                               &jleScene::findObjectByInstanceId);
 
     lua.set_function("LOGE", [](const std::string &s) {
         if (!plog::get<0>() || !plog::get<0>()->checkSeverity(plog::error)) {
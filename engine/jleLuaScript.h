@@ -14,6 +14,12 @@ public:
 
     jleLoadFromFileSuccessCode loadFromFile(const jlePath &path) override;
 
+    [[nodiscard]] bool
+    requiresMainThreadLoad() const override
+    {
+        return true;
+    }
+
     virtual void loadScript();
 
     void saveToFile() override;
@@ -32,7 +32,7 @@ public:
            CEREAL_NVP(roughnessTextureRef));
     }
 
-    SAVE_SHARED_THIS_SERIALIZED_JSON(jleSerializedResource)
+    SAVE_SHARED_THIS_SERIALIZED(jleSerializedResource)
 
     std::vector<std::string> getFileAssociationList() override;
 
@@ -1,8 +1,10 @@
 // Copyright (c) 2023. Johan Lind
 
 #include "jleMesh.h"
+#include "jleCore.h"
+#include "jleResource.h"
+#include "jleMeshOptimizer.h"
 #include "plog/Log.h"
-#include "tiny_obj_loader.h"
 #include <stdio.h>
 
 #include <assimp/Importer.hpp>
@@ -11,137 +13,57 @@
 
 #include "jleIncludeGL.h"
 
-jleLoadFromFileSuccessCode
-jleMesh::loadFromFile(const jlePath &path)
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace
 {
-    bool ret = loadFromObj(path);
-    if(ret)
-    {
-        return jleLoadFromFileSuccessCode::SUCCESS;
-    }else
-    {
-        return jleLoadFromFileSuccessCode::FAIL;
-    }
+glm::vec3
+safeNormalize(const glm::vec3 &v)
+{
+    const float length = glm::length(v);
+    return length > 0.f ? v / length : glm::vec3{0.f};
 }
+} // namespace
 
-bool
-jleMesh::loadFromObj(const jlePath &path)
+jleLoadFromFileSuccessCode
+jleMesh::loadFromFile(const jlePath &path)
 {
-
-    return loadAssimp(path);
-
-
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    const std::string materialPath = path.getRealPath().substr(0, path.getRealPath().find_last_of('/'));
-    bool loaded = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.getRealPath().c_str(), materialPath.c_str());
-
-    if (!err.empty()) {
-        LOGE << err;
-        return false;
-    }
-
-    const auto &vertices = attrib.vertices;
-    const auto &normals = attrib.normals;
-    const auto &texcoords = attrib.texcoords;
-
-    std::vector<glm::vec3> in_vertices;
-    std::vector<glm::vec3> in_normals;
-    std::vector<glm::vec2> in_uvs;
-
-    for (int i = 0; i < vertices.size(); i += 3) {
-        in_vertices.push_back({vertices[i], vertices[i + 1], vertices[i + 2]});
-    }
-
-    for (int i = 0; i < normals.size(); i += 3) {
-        in_normals.push_back({normals[i], normals[i + 1], normals[i + 2]});
-    }
-
-    for (int i = 0; i < texcoords.size(); i += 2) {
-        in_uvs.push_back({texcoords[i], texcoords[i + 1]});
+    jleMeshGeometry geometry;
+    if (!loadAssimp(path, geometry)) {
+        return jleLoadFromFileSuccessCode::FAIL;
     }
-
-    // If the OBJ file uses indexing for all attributes, then we simply go thru the
-    // mesh's indicies, and then find the attributes in the correct order, and then
-    // create new attribute arrays. We thus, do not use indexed rendering.
-    if (shapes[0].mesh.indices[0].normal_index >= 0) {
-        std::vector<glm::vec3> out_vertices;
-        std::vector<glm::vec2> out_uvs;
-        std::vector<glm::vec3> out_normals;
-
-        for (auto &&shape : shapes) {
-            for (unsigned int i = 0; i < shape.mesh.indices.size(); i++) {
-
-                // Get the indices of its attributes
-                int vertexIndex = shape.mesh.indices[i].vertex_index;
-                if (vertexIndex != -1) {
-                    glm::vec3 vertex = in_vertices[vertexIndex];
-                    out_vertices.push_back(vertex);
-                }
-
-                int uvIndex = shape.mesh.indices[i].texcoord_index;
-                if (uvIndex != -1) {
-                    glm::vec2 uv = in_uvs[uvIndex];
-                    out_uvs.push_back(uv);
-                }
-
-                int normalIndex = shape.mesh.indices[i].normal_index;
-                if (normalIndex != -1) {
-                    glm::vec3 normal = in_normals[normalIndex];
-                    out_normals.push_back(normal);
-                }
-            }
-        }
-
-        std::vector<glm::vec3> out_tangents;
-        std::vector<glm::vec3> out_bitangents;
-        if (!out_uvs.empty()) {
-            for (unsigned int i = 0; i < out_vertices.size(); i += 3) {
-                // Shortcuts for vertices
-                glm::vec3 &v0 = out_vertices[i + 0];
-                glm::vec3 &v1 = out_vertices[i + 1];
-                glm::vec3 &v2 = out_vertices[i + 2];
-
-                glm::vec2 &uv0 = out_uvs[i + 0];
-                glm::vec2 &uv1 = out_uvs[i + 1];
-                glm::vec2 &uv2 = out_uvs[i + 2];
-
-                glm::vec3 deltaPos1 = v1 - v0;
-                glm::vec3 deltaPos2 = v2 - v0;
-
-                glm::vec2 deltaUV1 = uv1 - uv0;
-                glm::vec2 deltaUV2 = uv2 - uv0;
-
-                float r = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV1.y * deltaUV2.x);
-                glm::vec3 tangent = (deltaPos1 * deltaUV2.y - deltaPos2 * deltaUV1.y) * r;
-                glm::vec3 bitangent = (deltaPos2 * deltaUV1.x - deltaPos1 * deltaUV2.x) * r;
-
-                out_tangents.push_back(tangent);
-                out_tangents.push_back(tangent);
-                out_tangents.push_back(tangent);
-                out_bitangents.push_back(bitangent);
-                out_bitangents.push_back(bitangent);
-                out_bitangents.push_back(bitangent);
+    jleMeshOptimizer::optimize(geometry, path.getVirtualPath());
+
+    // Importing and optimizing is most of the work and stays on the loading thread,
+    // only the upload waits for the main thread
+    if (gCore && !gCore->resources().isMainThread()) {
+        gCore->resources().runOnMainThread(this, [weakSelf = weak_from_this(), geometry = std::move(geometry)]() {
+            if (auto self = weakSelf.lock()) {
+                self->makeMesh(geometry.positions,
+                               geometry.normals,
+                               geometry.texCoords,
+                               geometry.tangents,
+                               geometry.bitangents,
+                               geometry.indices);
             }
-        }
-
-        makeMesh(out_vertices, out_normals, out_uvs, out_tangents, out_bitangents);
-        return true;
-
-    } else { // Else we can use the vertex indices as they are, and thus use indexed rendering
-        std::vector<unsigned int> vertexIndicies;
-        for (auto &&shape : shapes) {
-            for (int i = 0; i < shape.mesh.indices.size(); i++) {
-                vertexIndicies.push_back(shape.mesh.indices[i].vertex_index);
-            }
-        }
-
-        makeMesh(in_vertices, in_normals, in_uvs, {}, {}, vertexIndicies);
-        return true;
+        });
+    } else {
+        makeMesh(geometry.positions,
+                 geometry.normals,
+                 geometry.texCoords,
+                 geometry.tangents,
+                 geometry.bitangents,
+                 geometry.indices);
     }
+
+    return jleLoadFromFileSuccessCode::SUCCESS;
 }
 
 unsigned int
@@ -156,6 +78,12 @@ jleMesh::getTrianglesCount()
     return _trianglesCount;
 }
 
+unsigned int
+jleMesh::indexType() const
+{
+    return _indexType;
+}
+
 void
 jleMesh::makeMesh(const std::vector<glm::vec3> &positions,
                   const std::vector<glm::vec3> &normals,
@@ -167,70 +95,173 @@ jleMesh::makeMesh(const std::vector<glm::vec3> &positions,
 
     destroyOldBuffers();
 
+#ifndef BUILD_HEADLESS
+    const auto vertexCount = positions.size();
+
+    // Half floats stay within about a texel of a 1024 texture for coordinates up to 2, larger ones are kept as floats
+    const bool halfTexCoords = std::all_of(texCoords.begin(), texCoords.end(), [](const glm::vec2 &uv) {
+        return std::abs(uv.x) <= 2.f && std::abs(uv.y) <= 2.f;
+    });
+
+    // Offsets of the attributes in the interleaved vertex, -1 for missing attributes
+    std::size_t stride = 0;
+    auto addAttribute = [&](bool present, std::size_t size) {
+        if (!present) {
+            return -1;
+        }
+        const int offset = static_cast<int>(stride);
+        stride += size;
+        return offset;
+    };
+    const int positionOffset = addAttribute(!positions.empty(), sizeof(glm::vec3));
+    const int normalOffset = addAttribute(normals.size() == vertexCount, sizeof(uint32_t));
+    const int texCoordsOffset = addAttribute(texCoords.size() == vertexCount,
+                                             halfTexCoords ? sizeof(uint32_t) : sizeof(glm::vec2));
+    const int tangentOffset = addAttribute(tangents.size() == vertexCount, sizeof(uint32_t));
+
+    std::vector<uint8_t> vertices(stride * vertexCount);
+    for (std::size_t i = 0; i < vertexCount; i++) {
+        uint8_t *vertex = vertices.data() + i * stride;
+        std::memcpy(vertex + positionOffset, &positions[i], sizeof(glm::vec3));
+
+        if (normalOffset >= 0) {
+            const uint32_t normal = glm::packSnorm3x10_1x2(glm::vec4{safeNormalize(normals[i]), 0.f});
+            std::memcpy(vertex + normalOffset, &normal, sizeof(normal));
+        }
+
+        if (texCoordsOffset >= 0 && halfTexCoords) {
+            const uint32_t uv = glm::packHalf2x16(texCoords[i]);
+            std::memcpy(vertex + texCoordsOffset, &uv, sizeof(uv));
+        } else if (texCoordsOffset >= 0) {
+            std::memcpy(vertex + texCoordsOffset, &texCoords[i], sizeof(glm::vec2));
+        }
+
+        if (tangentOffset >= 0) {
+            // The bitangent is rebuilt from the normal and tangent in the shader, only its handedness is kept
+            float sign = 1.f;
+            if (bitangents.size() == vertexCount && normals.size() == vertexCount &&
+                glm::dot(glm::cross(normals[i], tangents[i]), bitangents[i]) < 0.f) {
+                sign = -1.f;
+            }
+            const uint32_t tangent = glm::packSnorm3x10_1x2(glm::vec4{safeNormalize(tangents[i]), sign});
+            std::memcpy(vertex + tangentOffset, &tangent, sizeof(tangent));
+        }
+    }
+
     glGenVertexArrays(1, &_vao);
     glBindVertexArray(_vao);
 
-    if (!positions.empty()) {
-        glGenBuffers(1, &_vbo_pos);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo_pos);
-        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), &positions[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0);
-        glEnableVertexAttribArray(0);
-    }
+    if (!vertices.empty()) {
+        glGenBuffers(1, &_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
-    if (!normals.empty()) {
-        glGenBuffers(1, &_vbo_normal);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo_normal);
-        glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(glm::vec3), &normals[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0);
-        glEnableVertexAttribArray(1);
-    }
+        const auto glStride = static_cast<GLsizei>(stride);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, glStride, (void *)(intptr_t)positionOffset);
+        glEnableVertexAttribArray(0);
 
-    if (!texCoords.empty()) {
-        glGenBuffers(1, &_vbo_texcoords);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo_texcoords);
-        glBufferData(GL_ARRAY_BUFFER, texCoords.size() * sizeof(glm::vec2), &texCoords[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0);
-        glEnableVertexAttribArray(2);
-    }
+        if (normalOffset >= 0) {
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, glStride, (void *)(intptr_t)normalOffset);
+            glEnableVertexAttribArray(1);
+        }
 
-    if (!tangents.empty()) {
-        glGenBuffers(1, &_vbo_tangent);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo_tangent);
-        glBufferData(GL_ARRAY_BUFFER, tangents.size() * sizeof(glm::vec3), &tangents[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0);
-        glEnableVertexAttribArray(3);
-    }
+        if (texCoordsOffset >= 0) {
+            glVertexAttribPointer(2,
+                                  2,
+                                  halfTexCoords ? GL_HALF_FLOAT : GL_FLOAT,
+                                  GL_FALSE,
+                                  glStride,
+                                  (void *)(intptr_t)texCoordsOffset);
+            glEnableVertexAttribArray(2);
+        }
 
-    if (!bitangents.empty()) {
-        glGenBuffers(1, &_vbo_bitangent);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo_bitangent);
-        glBufferData(GL_ARRAY_BUFFER, bitangents.size() * sizeof(glm::vec3), &bitangents[0], GL_STATIC_DRAW);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0);
-        glEnableVertexAttribArray(4);
+        if (tangentOffset >= 0) {
+            glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, glStride, (void *)(intptr_t)tangentOffset);
+            glEnableVertexAttribArray(3);
+        }
     }
 
     if (!indices.empty()) {
         glGenBuffers(1, &_ebo);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        if (vertexCount <= std::numeric_limits<uint16_t>::max() + std::size_t{1}) {
+            const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                         shortIndices.size() * sizeof(uint16_t),
+                         shortIndices.data(),
+                         GL_STATIC_DRAW);
+            _indexType = GL_UNSIGNED_SHORT;
+        } else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+            _indexType = GL_UNSIGNED_INT;
+        }
     }
 
     glBindVertexArray(0);
+#endif
 
-    if (indices.size() > 0) {
+    _indexed = !indices.empty();
+    if (_indexed) {
         _trianglesCount = indices.size();
     } else {
         _trianglesCount = positions.size();
     }
 
-    _positions = positions;
-    _normals = normals;
-    _texCoords = texCoords;
-    _tangents = tangents;
-    _bitangents = bitangents;
-    _indices = indices;
+    // The GPU has its own copy, only keep one on the CPU for those that read the vertices, such as rigidbodies
+    if (!gCore || gCore->settings().keepMeshVertexData) {
+        _positions = positions;
+        _normals = normals;
+        _texCoords = texCoords;
+        _tangents = tangents;
+        _bitangents = bitangents;
+        _indices = indices;
+    } else {
+        _positions = {};
+        _normals = {};
+        _texCoords = {};
+        _tangents = {};
+        _bitangents = {};
+        _indices = {};
+    }
+
+    // The sphere is centered on the box, which is close to the smallest sphere for most meshes
+    _boundsMin = positions.empty() ? glm::vec3{0.f} : positions[0];
+    _boundsMax = _boundsMin;
+    for (auto &&position : positions) {
+        _boundsMin = glm::min(_boundsMin, position);
+        _boundsMax = glm::max(_boundsMax, position);
+    }
+    _boundingSphereCenter = (_boundsMin + _boundsMax) * 0.5f;
+    float radiusSquared = 0.f;
+    for (auto &&position : positions) {
+        const auto offset = position - _boundingSphereCenter;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    _boundingSphereRadius = std::sqrt(radiusSquared);
+}
+
+const glm::vec3 &
+jleMesh::boundsMin() const
+{
+    return _boundsMin;
+}
+
+const glm::vec3 &
+jleMesh::boundsMax() const
+{
+    return _boundsMax;
+}
+
+const glm::vec3 &
+jleMesh::boundingSphereCenter() const
+{
+    return _boundingSphereCenter;
+}
 
+float
+jleMesh::boundingSphereRadius() const
+{
+    return _boundingSphereRadius;
 }
 
 jleMesh::~jleMesh() { destroyOldBuffers(); }
@@ -238,25 +269,9 @@ jleMesh::~jleMesh() { destroyOldBuffers(); }
 void
 jleMesh::destroyOldBuffers()
 {
-    if (_vbo_pos) {
-        glDeleteBuffers(1, &_vbo_pos);
-        _vbo_pos = 0;
-    }
-    if (_vbo_normal) {
-        glDeleteBuffers(1, &_vbo_normal);
-        _vbo_normal = 0;
-    }
-    if (_vbo_texcoords) {
-        glDeleteBuffers(1, &_vbo_texcoords);
-        _vbo_texcoords = 0;
-    }
-    if (_vbo_tangent) {
-        glDeleteBuffers(1, &_vbo_tangent);
-        _vbo_tangent = 0;
-    }
-    if (_vbo_bitangent) {
-        glDeleteBuffers(1, &_vbo_bitangent);
-        _vbo_bitangent = 0;
+    if (_vbo) {
+        glDeleteBuffers(1, &_vbo);
+        _vbo = 0;
     }
     if (_ebo) {
         glDeleteBuffers(1, &_ebo);
@@ -271,11 +286,11 @@ jleMesh::destroyOldBuffers()
 bool
 jleMesh::usesIndexing()
 {
-    return _ebo > 0;
+    return _indexed;
 }
 
 bool
-jleMesh::loadAssimp(const jlePath &path)
+jleMesh::loadAssimp(const jlePath &path, jleMeshGeometry &geometry)
 {
     auto pathStr = path.getRealPath();
 
@@ -298,6 +313,9 @@ jleMesh::loadAssimp(const jlePath &path)
 
     for(int i = 0; i < scene->mNumMeshes; i++){
         auto assimpMesh = scene->mMeshes[i];
+
+        // Each mesh indexes its own vertices, which follow the previous meshes' vertices
+        const auto baseVertex = static_cast<unsigned int>(out_vertices.size());
         for(int j = 0; j < assimpMesh->mNumVertices; j++){
 
             glm::vec3 position;
@@ -330,9 +348,9 @@ jleMesh::loadAssimp(const jlePath &path)
                 out_tangents.push_back(tangent);
 
                 glm::vec3 bitangent;
-                tangent.x = assimpMesh->mBitangents[j].x;
-                tangent.y = assimpMesh->mBitangents[j].y;
-                tangent.z = assimpMesh->mBitangents[j].z;
+                bitangent.x = assimpMesh->mBitangents[j].x;
+                bitangent.y = assimpMesh->mBitangents[j].y;
+                bitangent.z = assimpMesh->mBitangents[j].z;
                 out_bitangents.push_back(bitangent);
 
             }
@@ -343,13 +361,18 @@ jleMesh::loadAssimp(const jlePath &path)
             const auto &face = assimpMesh->mFaces[i];
             for(int j = 0; j < face.mNumIndices; j++)
             {
-                out_indices.push_back(face.mIndices[j]);
+                out_indices.push_back(baseVertex + face.mIndices[j]);
             }
         }
 
     }
 
-    makeMesh(out_vertices, out_normals, out_uvs, out_tangents, out_bitangents, out_indices);
+    geometry = {std::move(out_vertices),
+                std::move(out_normals),
+                std::move(out_uvs),
+                std::move(out_tangents),
+                std::move(out_bitangents),
+                std::move(out_indices)};
 
     return true;
 }
@@ -4,22 +4,29 @@
 
 #include "jleResourceInterface.h"
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 
-class jleMesh : public jleResourceInterface
+struct jleMeshGeometry;
+
+class jleMesh : public jleResourceInterface, public std::enable_shared_from_this<jleMesh>
 {
 public:
     ~jleMesh() override;
 
+    // Imports and optimizes the mesh on the calling thread. From a background thread, the upload
+    // to the GPU is deferred to the main thread, so the mesh is empty until the main thread has run,
+    // and jleResources::isLoaded() is false until then.
     jleLoadFromFileSuccessCode loadFromFile(const jlePath &path) override;
 
-    // Synchronous OBJ loading
-    bool loadFromObj(const jlePath &path);
-
-    bool loadAssimp(const jlePath &path);
+    // Reads the vertices of all meshes in the file, without uploading them
+    static bool loadAssimp(const jlePath &path, jleMeshGeometry &geometry);
 
-    // Lays out the attributes in the order:
-    // position (0), normal (1), texcoords (2), tangent (3), bitangent (4)
+    // Uploads the attributes interleaved in one buffer, at the locations:
+    // position (0), normal (1), texcoords (2), tangent (3).
+    // Normals and tangents are packed to 10:10:10:2 snorm, with the bitangent's sign in the tangent's w,
+    // and texture coordinates to half floats when they are small enough to keep their precision.
+    // Indices are 16 bit when there are few enough vertices.
     void makeMesh(const std::vector<glm::vec3> &positions,
                   const std::vector<glm::vec3> &normals = {},
                   const std::vector<glm::vec2> &texCoords = {},
@@ -27,12 +34,17 @@ public:
                   const std::vector<glm::vec3> &bitangents = {},
                   const std::vector<unsigned int> &indicies = {});
 
+    // If the mesh was made with indices, also without a GL context
     bool usesIndexing();
 
     unsigned int getVAO();
 
     unsigned int getTrianglesCount();
 
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    [[nodiscard]] unsigned int indexType() const;
+
+    // Copies of the vertex data, empty if the engine settings don't keep mesh vertex data
     const std::vector<glm::vec3>& positions();
 
     const std::vector<glm::vec3>& normals();
@@ -45,20 +57,27 @@ public:
 
     const std::vector<unsigned int>& indices();
 
+    // Local space bounds of the positions, computed when the mesh is made
+    [[nodiscard]] const glm::vec3 &boundsMin() const;
+
+    [[nodiscard]] const glm::vec3 &boundsMax() const;
+
+    [[nodiscard]] const glm::vec3 &boundingSphereCenter() const;
+
+    [[nodiscard]] float boundingSphereRadius() const;
+
     std::vector<std::string> getFileAssociationList() override;
 
 private:
     void destroyOldBuffers();
 
     unsigned int _trianglesCount{};
+    bool _indexed{false};
 
     unsigned int _vao{};
-    unsigned int _vbo_pos{};
-    unsigned int _vbo_normal{};
-    unsigned int _vbo_texcoords{};
-    unsigned int _vbo_tangent{};
-    unsigned int _vbo_bitangent{};
+    unsigned int _vbo{};
     unsigned int _ebo{};
+    unsigned int _indexType{};
 
     std::vector<glm::vec3> _positions{};
     std::vector<glm::vec3> _normals{};
@@ -66,4 +85,9 @@ private:
     std::vector<glm::vec3> _tangents{};
     std::vector<glm::vec3> _bitangents{};
     std::vector<unsigned int> _indices{};
+
+    glm::vec3 _boundsMin{0.f};
+    glm::vec3 _boundsMax{0.f};
+    glm::vec3 _boundingSphereCenter{0.f};
+    float _boundingSphereRadius{0.f};
 };
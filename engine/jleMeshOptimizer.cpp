@@ -0,0 +1,437 @@
+// Copyright (c) 2023. Johan Lind
+
+#include "jleMeshOptimizer.h"
+#include "jleProfiler.h"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+constexpr uint32_t noIndex = UINT32_MAX;
+
+// Cache simulated when optimizing, larger than the hardware's so that the order suits most GPUs
+constexpr int forsythCacheSize = 32;
+
+// Vertices in the cache score by how recently they were used, except for the last triangle's, so
+// that the order doesn't turn back on itself. Vertices with few triangles left get a boost, so that
+// they are finished off instead of being left alone for later.
+float
+forsythVertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0) {
+        return -1.f;
+    }
+
+    float score = 0.f;
+    if (cachePosition >= 0 && cachePosition < 3) {
+        score = 0.75f;
+    } else if (cachePosition >= 3) {
+        score = std::pow(1.f - float(cachePosition - 3) / float(forsythCacheSize - 3), 1.5f);
+    }
+    return score + 2.f / std::sqrt(float(remainingTriangles));
+}
+
+template <typename T>
+std::size_t
+hashAttribute(std::size_t hash, const T &value)
+{
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+    uint32_t words[sizeof(T) / sizeof(uint32_t)];
+    std::memcpy(words, &value, sizeof(T));
+    for (auto &&word : words) {
+        hash = (hash ^ word) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void
+remapAttribute(std::vector<T> &attribute, const std::vector<uint32_t> &remap, uint32_t count)
+{
+    if (attribute.empty()) {
+        return;
+    }
+    std::vector<T> remapped(count);
+    for (std::size_t v = 0; v < attribute.size(); v++) {
+        if (remap[v] != noIndex) {
+            remapped[remap[v]] = attribute[v];
+        }
+    }
+    attribute.swap(remapped);
+}
+} // namespace
+
+void
+jleMeshOptimizer::optimize(jleMeshGeometry &geometry, const std::string &name)
+{
+    JLE_SCOPE_PROFILE_CPU(jleMeshOptimizer_optimize)
+
+    const std::size_t verticesBefore = geometry.positions.size();
+    if (std::any_of(geometry.indices.begin(), geometry.indices.end(), [&](unsigned int index) {
+            return index >= verticesBefore;
+        })) {
+        LOGW << "Mesh " << name << " has indices out of range, it is left unoptimized";
+        return;
+    }
+
+    // Unindexed triangles transform every vertex
+    const float acmrBefore =
+        geometry.indices.empty() ? (verticesBefore >= 3 ? 3.f : 0.f) : acmr(geometry.indices, verticesBefore);
+
+    weld(geometry);
+    optimizeVertexCache(geometry.indices, geometry.positions.size());
+    optimizeOverdraw(geometry.indices, geometry.positions);
+    optimizeVertexFetch(geometry);
+
+    LOGI << "Optimized mesh " << name << ": " << verticesBefore << " -> " << geometry.positions.size()
+         << " vertices, ACMR " << acmrBefore << " -> " << acmr(geometry.indices, geometry.positions.size());
+}
+
+void
+jleMeshOptimizer::weld(jleMeshGeometry &geometry)
+{
+    auto &positions = geometry.positions;
+    auto &normals = geometry.normals;
+    auto &texCoords = geometry.texCoords;
+    auto &tangents = geometry.tangents;
+    auto &bitangents = geometry.bitangents;
+    const std::size_t vertexCount = positions.size();
+
+    auto dropMismatched = [&](auto &attribute, const char *attributeName) {
+        if (!attribute.empty() && attribute.size() != vertexCount) {
+            LOGW << "Dropping mesh " << attributeName << ", there are " << attribute.size() << " for "
+                 << vertexCount << " vertices";
+            attribute.clear();
+        }
+    };
+    dropMismatched(normals, "normals");
+    dropMismatched(texCoords, "texture coordinates");
+    dropMismatched(tangents, "tangents");
+    dropMismatched(bitangents, "bitangents");
+
+    auto hashVertex = [&](std::size_t v) {
+        std::size_t hash = hashAttribute(2166136261u, positions[v]);
+        if (!normals.empty()) {
+            hash = hashAttribute(hash, normals[v]);
+        }
+        if (!texCoords.empty()) {
+            hash = hashAttribute(hash, texCoords[v]);
+        }
+        if (!tangents.empty()) {
+            hash = hashAttribute(hash, tangents[v]);
+        }
+        if (!bitangents.empty()) {
+            hash = hashAttribute(hash, bitangents[v]);
+        }
+        return hash;
+    };
+
+    auto equalVertices = [&](std::size_t a, std::size_t b) {
+        return positions[a] == positions[b] && (normals.empty() || normals[a] == normals[b]) &&
+               (texCoords.empty() || texCoords[a] == texCoords[b]) &&
+               (tangents.empty() || tangents[a] == tangents[b]) &&
+               (bitangents.empty() || bitangents[a] == bitangents[b]);
+    };
+
+    // Open addressing table of the unique vertices. Unique vertices are compacted to the front as they
+    // are found, which never overwrites a vertex that hasn't been looked at yet.
+    std::size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) {
+        tableSize <<= 1;
+    }
+    std::vector<uint32_t> table(tableSize, noIndex);
+    std::vector<uint32_t> remap(vertexCount);
+    uint32_t uniqueCount = 0;
+
+    for (std::size_t v = 0; v < vertexCount; v++) {
+        std::size_t slot = hashVertex(v) & (tableSize - 1);
+        while (table[slot] != noIndex && !equalVertices(table[slot], v)) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] != noIndex) {
+            remap[v] = table[slot];
+            continue;
+        }
+
+        positions[uniqueCount] = positions[v];
+        if (!normals.empty()) {
+            normals[uniqueCount] = normals[v];
+        }
+        if (!texCoords.empty()) {
+            texCoords[uniqueCount] = texCoords[v];
+        }
+        if (!tangents.empty()) {
+            tangents[uniqueCount] = tangents[v];
+        }
+        if (!bitangents.empty()) {
+            bitangents[uniqueCount] = bitangents[v];
+        }
+        table[slot] = uniqueCount;
+        remap[v] = uniqueCount++;
+    }
+
+    auto shrink = [&](auto &attribute) {
+        if (!attribute.empty()) {
+            attribute.resize(uniqueCount);
+        }
+    };
+    shrink(positions);
+    shrink(normals);
+    shrink(texCoords);
+    shrink(tangents);
+    shrink(bitangents);
+
+    if (geometry.indices.empty()) {
+        geometry.indices.assign(remap.begin(), remap.end());
+    } else {
+        for (auto &&index : geometry.indices) {
+            index = remap[index];
+        }
+    }
+}
+
+void
+jleMeshOptimizer::optimizeVertexCache(std::vector<unsigned int> &indices, std::size_t vertexCount)
+{
+    JLE_SCOPE_PROFILE_CPU(jleMeshOptimizer_optimizeVertexCache)
+
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Triangles not yet emitted that use each vertex, the first remaining[v] after offsets[v]
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    std::vector<uint32_t> remaining(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; v++) {
+        remaining[v] = offsets[v + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < triangleCount * 3; i++) {
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; v++) {
+        vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    for (std::size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] =
+            vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<unsigned int> ordered;
+    ordered.reserve(triangleCount * 3);
+
+    std::vector<uint32_t> cache, nextCache;
+    cache.reserve(forsythCacheSize + 3);
+    nextCache.reserve(forsythCacheSize + 3);
+
+    uint32_t best = static_cast<uint32_t>(std::max_element(triangleScore.begin(), triangleScore.end()) -
+                                          triangleScore.begin());
+    std::size_t scanCursor = 0;
+
+    while (ordered.size() < triangleCount * 3) {
+        // When no triangle touches the cache, continue with the first one left in the original order
+        if (best == noIndex) {
+            while (emitted[scanCursor]) {
+                scanCursor++;
+            }
+            best = static_cast<uint32_t>(scanCursor);
+        }
+
+        emitted[best] = 1;
+        nextCache.clear();
+        for (int k = 0; k < 3; k++) {
+            const auto v = indices[best * 3 + k];
+            ordered.push_back(v);
+
+            // Degenerate triangles use a vertex more than once, it only takes one cache entry
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+                nextCache.push_back(v);
+            }
+
+            auto first = adjacency.begin() + offsets[v];
+            auto last = first + remaining[v];
+            std::iter_swap(std::find(first, last, best), last - 1);
+            remaining[v]--;
+        }
+        const auto emittedVertices = nextCache.size();
+        for (auto &&v : cache) {
+            if (std::find(nextCache.begin(), nextCache.begin() + emittedVertices, v) ==
+                nextCache.begin() + emittedVertices) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // Vertices pushed out of the cache are rescored too, with no cache position
+        for (std::size_t i = 0; i < nextCache.size(); i++) {
+            const auto v = nextCache[i];
+            cachePosition[v] = static_cast<int>(i) < forsythCacheSize ? static_cast<int>(i) : -1;
+            vertexScore[v] = forsythVertexScore(cachePosition[v], remaining[v]);
+        }
+
+        best = noIndex;
+        float bestScore = -1.f;
+        for (auto &&v : nextCache) {
+            for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+                const auto t = adjacency[a];
+                triangleScore[t] =
+                    vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (triangleScore[t] > bestScore) {
+                    best = t;
+                    bestScore = triangleScore[t];
+                }
+            }
+        }
+
+        if (nextCache.size() > static_cast<std::size_t>(forsythCacheSize)) {
+            nextCache.resize(forsythCacheSize);
+        }
+        std::swap(cache, nextCache);
+    }
+
+    indices.swap(ordered);
+}
+
+void
+jleMeshOptimizer::optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions)
+{
+    JLE_SCOPE_PROFILE_CPU(jleMeshOptimizer_optimizeOverdraw)
+
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // A new cluster starts at each triangle that misses the cache with all its vertices. Clusters
+    // can be moved around without losing much cache locality, since the cache starts over there anyway.
+    constexpr uint32_t cacheSize = 16;
+    std::vector<uint32_t> insertedAt(positions.size(), 0);
+    uint32_t misses = 0;
+    std::vector<uint32_t> clusterStarts;
+    for (std::size_t t = 0; t < triangleCount; t++) {
+        int triangleMisses = 0;
+        for (int k = 0; k < 3; k++) {
+            const auto v = indices[t * 3 + k];
+            if (insertedAt[v] == 0 || misses - insertedAt[v] >= cacheSize) {
+                insertedAt[v] = ++misses;
+                triangleMisses++;
+            }
+        }
+        if (t == 0 || triangleMisses == 3) {
+            clusterStarts.push_back(static_cast<uint32_t>(t));
+        }
+    }
+    if (clusterStarts.size() < 2) {
+        return;
+    }
+    clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+    const std::size_t clusterCount = clusterStarts.size() - 1;
+
+    // Area weighted centers of the clusters and of the mesh, and the clusters' average normals
+    std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3{0.f});
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3{0.f});
+    glm::vec3 meshCenter{0.f};
+    float meshArea = 0.f;
+    for (std::size_t c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.f;
+        for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            const auto &p0 = positions[indices[t * 3]];
+            const auto &p1 = positions[indices[t * 3 + 1]];
+            const auto &p2 = positions[indices[t * 3 + 2]];
+            const auto normal = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(normal) * 0.5f;
+            const auto center = (p0 + p1 + p2) / 3.f;
+
+            clusterCenters[c] += center * area;
+            clusterNormals[c] += normal;
+            clusterArea += area;
+        }
+        meshCenter += clusterCenters[c];
+        meshArea += clusterArea;
+        if (clusterArea > 0.f) {
+            clusterCenters[c] /= clusterArea;
+        }
+    }
+    if (meshArea > 0.f) {
+        meshCenter /= meshArea;
+    }
+
+    // Clusters facing away from the center are on the outside of the mesh, and drawn first
+    std::vector<float> clusterSortKeys(clusterCount);
+    for (std::size_t c = 0; c < clusterCount; c++) {
+        const float normalLength = glm::length(clusterNormals[c]);
+        clusterSortKeys[c] =
+            normalLength > 0.f ? glm::dot(clusterCenters[c] - meshCenter, clusterNormals[c] / normalLength) : 0.f;
+    }
+
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) {
+        return clusterSortKeys[a] > clusterSortKeys[b];
+    });
+
+    std::vector<unsigned int> ordered;
+    ordered.reserve(indices.size());
+    for (auto &&c : clusterOrder) {
+        ordered.insert(ordered.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+    }
+    indices.swap(ordered);
+}
+
+void
+jleMeshOptimizer::optimizeVertexFetch(jleMeshGeometry &geometry)
+{
+    std::vector<uint32_t> remap(geometry.positions.size(), noIndex);
+    uint32_t vertexCount = 0;
+    for (auto &&index : geometry.indices) {
+        if (remap[index] == noIndex) {
+            remap[index] = vertexCount++;
+        }
+        index = remap[index];
+    }
+
+    remapAttribute(geometry.positions, remap, vertexCount);
+    remapAttribute(geometry.normals, remap, vertexCount);
+    remapAttribute(geometry.texCoords, remap, vertexCount);
+    remapAttribute(geometry.tangents, remap, vertexCount);
+    remapAttribute(geometry.bitangents, remap, vertexCount);
+}
+
+float
+jleMeshOptimizer::acmr(const std::vector<unsigned int> &indices, std::size_t vertexCount, int cacheSize)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return 0.f;
+    }
+
+    // Vertices stay in the cache until cacheSize other vertices were added after them
+    std::vector<uint32_t> insertedAt(vertexCount, 0);
+    uint32_t misses = 0;
+    for (std::size_t i = 0; i < triangleCount * 3; i++) {
+        const auto v = indices[i];
+        if (insertedAt[v] == 0 || misses - insertedAt[v] >= static_cast<uint32_t>(cacheSize)) {
+            insertedAt[v] = ++misses;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
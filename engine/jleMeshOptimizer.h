@@ -0,0 +1,49 @@
+// Copyright (c) 2023. Johan Lind
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Vertex attributes and indices as passed to jleMesh::makeMesh(). Attributes are either
+// empty or have one element per position, no indices means a list of unindexed triangles.
+struct jleMeshGeometry {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> tangents;
+    std::vector<glm::vec3> bitangents;
+    std::vector<unsigned int> indices;
+};
+
+// Optimizations done to meshes when they are imported, so that the GPU transforms fewer
+// vertices, shades fewer hidden fragments and fetches vertex data in order.
+class jleMeshOptimizer
+{
+public:
+    // Welds, reorders for the vertex cache and overdraw, then for vertex fetch, and logs the
+    // average cache miss ratio (ACMR, transformed vertices per triangle) before and after
+    static void optimize(jleMeshGeometry &geometry, const std::string &name);
+
+    // Merges vertices whose attributes are all equal, indexing meshes that weren't indexed.
+    // Attributes that don't have one element per position are dropped.
+    static void weld(jleMeshGeometry &geometry);
+
+    // Orders the triangles so that they reuse recently transformed vertices, with Tom Forsyth's
+    // "Linear-Speed Vertex Cache Optimisation"
+    static void optimizeVertexCache(std::vector<unsigned int> &indices, std::size_t vertexCount);
+
+    // Splits the triangles into clusters where the vertex cache is missed completely anyway, and
+    // orders the clusters facing out from the mesh's center first, so that they occlude the rest.
+    // After Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+    static void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions);
+
+    // Renumbers the vertices in the order the triangles first use them, dropping unused ones
+    static void optimizeVertexFetch(jleMeshGeometry &geometry);
+
+    // Vertices transformed per triangle with a FIFO post-transform cache, 0.5 at best and 3 at worst
+    static float acmr(const std::vector<unsigned int> &indices, std::size_t vertexCount, int cacheSize = 16);
+};
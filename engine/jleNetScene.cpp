@@ -60,6 +60,9 @@ void jleNetScene::processNetMessage(const std::string &event,
     }
 
     if (event == "SceneSync") {
+        for (auto &&object : _sceneObjects) {
+            unregisterObjectTree(object.get());
+        }
         _sceneObjects.clear();
         _newSceneObjects.clear();
 
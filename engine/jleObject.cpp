@@ -5,6 +5,7 @@
 #include "cLuaScript.h"
 #include "jleCore.h"
 #include "jleGameEngine.h"
+#include "jleObjectTemplateCache.h"
 #include "jlePathDefines.h"
 #include "jleScene.h"
 #include "jleTransform.h"
@@ -24,13 +25,17 @@ jleObject::destroyComponent(jleComponent *component)
         if (_components[i].get() == component) {
             if (!gEngine->isGameKilled()) {
 
-                if (auto luaScriptComponent = getComponent<cLuaScript>()) {
+                if (auto luaScriptComponent = findComponent<cLuaScript>()) {
                     luaScriptComponent->getSelf()[component->componentName()] = sol::lua_nil;
                 }
 
                 component->onDestroy();
             }
+            if (component->_pool) {
+                component->_pool->remove(component);
+            }
             _components.erase(_components.begin() + i);
+            rebuildComponentTypeIndex();
         }
     }
 }
@@ -39,6 +44,11 @@ void
 jleObject::destroyObject()
 {
     _pendingKill = true;
+
+    // Killed objects are removed by the update loop, which skips trees that sleep
+    if (_containedInScene) {
+        _containedInScene->linkAwakeObject(this);
+    }
 }
 
 int
@@ -69,25 +79,20 @@ jleObject::attachChildObject(const std::shared_ptr<jleObject> &object)
         auto it = std::find(
             object->_parentObject->__childObjects.begin(), object->_parentObject->__childObjects.end(), object);
         object->_parentObject->__childObjects.erase(it);
-    } else {
-        // Else the object is directly in the scene
-        // Remove the object from existing directly in the scene, and instead as
-        // a node under this object
-        if (object->_isStarted) {
-            auto it =
-                std::find(_containedInScene->_sceneObjects.begin(), _containedInScene->_sceneObjects.end(), object);
-            if (it != _containedInScene->_sceneObjects.end()) {
-                _containedInScene->_sceneObjects.erase(it);
-            }
-        }
+    } else if (object->_inSceneObjectList) {
+        // Else the object is directly in the scene. Its entry in the scene's root objects
+        // is left in place and skipped, the scene drops it the next time it compacts the list
+        _containedInScene->_sceneObjectsNeedCompaction = true;
+        _containedInScene->unlinkAwakeObject(object.get());
     }
 
     object->_parentObject = this;
     __childObjects.push_back(object);
+    if (_containedInScene) {
+        _containedInScene->linkAwakeObject(this);
+    }
 
-    // if (auto t = object->component<cTransform>()) {
-    // t->flagDirty();
-    // }
+    object->_transform.flagDirty();
 }
 
 void
@@ -104,11 +109,20 @@ jleObject::detachObjectFromParent()
             }
             i++;
         }
-        // Insert this object to be contained directly in the scene
-        _containedInScene->_sceneObjects.push_back(thiz);
+        // Insert this object to be contained directly in the scene, unless the
+        // entry from before it was attached has not been compacted away yet
+        if (!_inSceneObjectList) {
+            _containedInScene->_sceneObjects.push_back(thiz);
+            _inSceneObjectList = true;
+        }
     }
 
     _parentObject = nullptr;
+    if (_containedInScene) {
+        _containedInScene->linkAwakeObject(this);
+    }
+
+    _transform.flagDirty();
 }
 
 jleObject::jleObject(jleScene *scene) : _containedInScene{scene}, _transform{this} {}
@@ -124,8 +138,15 @@ jleObject::startComponents()
 void
 jleObject::updateComponents(float dt)
 {
+    // Without component pools there is no batch to spread over threads,
+    // so the parallel phase runs serially right before the sync phase
     for (int i = _components.size() - 1; i >= 0; i--) {
-        _components[i]->update(dt);
+        auto &component = _components[i];
+        float tickDt;
+        if (componentNeedsUpdates(component.get()) && component->consumeTick(dt, tickDt)) {
+            component->parallelUpdate(tickDt);
+            component->update(tickDt);
+        }
     }
 }
 
@@ -140,27 +161,40 @@ jleObject::updateComponentsEditor(float dt)
 void
 jleObject::updateChildren(float dt)
 {
+    // With component pools the scene updates all components in per-type batches
+    const bool componentsPooled = _containedInScene && _containedInScene->componentPoolsEnabled();
+
+    bool anyPendingKill = false;
     for (int32_t i = __childObjects.size() - 1; i >= 0; i--) {
         if (__childObjects[i]->_pendingKill) {
-            __childObjects[i]->propagateDestroy();
-            __childObjects.erase(__childObjects.begin() + i);
+            anyPendingKill = true;
             continue;
         }
 
-        __childObjects[i]->update(dt);
-        __childObjects[i]->updateComponents(dt);
+        // Children of a sleeping object sleep too, but may have components that update while sleeping
+        if (!__childObjects[i]->_sleeping) {
+            __childObjects[i]->update(dt);
+        }
+        if (!componentsPooled) {
+            __childObjects[i]->updateComponents(dt);
+        }
 
         // Recursively update children after this object has updated
         __childObjects[i]->updateChildren(dt);
     }
+
+    if (anyPendingKill) {
+        removePendingKillChildren(true);
+    }
 }
 
 void
 jleObject::updateChildrenEditor(float dt)
 {
+    bool anyPendingKill = false;
     for (int32_t i = __childObjects.size() - 1; i >= 0; i--) {
         if (__childObjects[i]->_pendingKill) {
-            __childObjects.erase(__childObjects.begin() + i);
+            anyPendingKill = true;
             continue;
         }
 
@@ -170,6 +204,76 @@ jleObject::updateChildrenEditor(float dt)
         // Recursively update children after this object has updated
         __childObjects[i]->updateChildrenEditor(dt);
     }
+
+    if (anyPendingKill) {
+        removePendingKillChildren(false);
+    }
+}
+
+int
+jleObject::componentIndexOfType(uint32_t typeId)
+{
+    if (typeId >= _componentIndexByType.size()) {
+        // The type got its ID after the table was built
+        rebuildComponentTypeIndex();
+    }
+    return _componentIndexByType[typeId];
+}
+
+void
+jleObject::indexLastComponentType()
+{
+    if (_componentIndexByType.size() < jleTypeReflectionUtils::componentTypeCount()) {
+        rebuildComponentTypeIndex();
+        return;
+    }
+
+    const int index = static_cast<int>(_components.size()) - 1;
+    const auto *component = _components[index].get();
+    for (auto typeId : jleTypeReflectionUtils::componentTypeIdsOf(component->componentTypeId(), component)) {
+        if (_componentIndexByType[typeId] < 0) {
+            _componentIndexByType[typeId] = index;
+        }
+    }
+}
+
+void
+jleObject::rebuildComponentTypeIndex()
+{
+    _componentIndexByType.assign(jleTypeReflectionUtils::componentTypeCount(), -1);
+    for (int i = 0; i < static_cast<int>(_components.size()); i++) {
+        const auto *component = _components[i].get();
+        for (auto typeId : jleTypeReflectionUtils::componentTypeIdsOf(component->componentTypeId(), component)) {
+            if (_componentIndexByType[typeId] < 0) {
+                _componentIndexByType[typeId] = i;
+            }
+        }
+    }
+}
+
+void
+jleObject::removePendingKillChildren(bool propagateDestroy)
+{
+    // Single pass that keeps the order of the remaining children. Indexed, since
+    // onDestroy() may attach or detach objects and thereby grow the vector.
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < __childObjects.size(); i++) {
+        auto child = __childObjects[i];
+        if (child->_pendingKill) {
+            if (propagateDestroy) {
+                child->propagateDestroy();
+                if (_containedInScene) {
+                    __childObjects[i] = nullptr;
+                    _containedInScene->recycleObject(std::move(child));
+                }
+            } else if (_containedInScene) {
+                _containedInScene->unregisterObjectTree(child.get());
+            }
+            continue;
+        }
+        __childObjects[kept++] = std::move(child);
+    }
+    __childObjects.resize(kept);
 }
 
 jleObject *
@@ -181,26 +285,31 @@ jleObject::parent()
 std::weak_ptr<jleObject>
 jleObject::weakPtrToThis()
 {
+    _weakReferenced = true;
     return weak_from_this();
 }
 
 std::shared_ptr<jleObject>
 jleObject::duplicate(bool childChain)
 {
-    auto duplicated = clone();
+    auto duplicated = _containedInScene->cloneObject(*this);
 
     duplicated->_components.clear();
     duplicated->__childObjects.clear();
     duplicated->_transform._owner = duplicated.get();
+    duplicated->_transform._dirty = true;
     duplicated->_instanceID = _instanceIdCounter++;
     duplicated->_isStarted = false; // Note that duplicating an object will run its start function!
+    duplicated->_inSceneObjectList = false;
+    duplicated->_handle = {};
 
     for (auto &&component : _components) {
-        auto clonedComponent = component->clone();
+        auto clonedComponent = _containedInScene->cloneComponent(*component);
         clonedComponent->_containedInScene = _containedInScene;
         clonedComponent->_attachedToObject = duplicated.get();
         duplicated->_components.push_back(clonedComponent);
     }
+    duplicated->rebuildComponentTypeIndex();
 
     for (auto &&object : __childObjects) {
         auto duplicatedChild = object->duplicate(true);
@@ -214,9 +323,19 @@ jleObject::duplicate(bool childChain)
         duplicated->parent()->__childObjects.push_back(duplicated);
     }
 
+    if (!childChain) {
+        duplicated->propagateOwnedByScene(_containedInScene);
+    }
+
     return duplicated;
 }
 
+void
+jleObject::resetObjectForReuse()
+{
+    _transform = jleTransform{this};
+}
+
 std::shared_ptr<jleObject>
 jleObject::duplicateTemplate(bool childChain)
 {
@@ -225,13 +344,17 @@ jleObject::duplicateTemplate(bool childChain)
     duplicated->_components.clear();
     duplicated->__childObjects.clear();
     duplicated->_instanceID = _instanceIdCounter++;
+    duplicated->_inSceneObjectList = false;
+    duplicated->_handle = {};
     duplicated->_transform._owner = duplicated.get();
+    duplicated->_transform._dirty = true;
 
     for (auto &&component : _components) {
         auto clonedComponent = component->clone();
         clonedComponent->_attachedToObject = duplicated.get();
         duplicated->_components.push_back(clonedComponent);
     }
+    duplicated->rebuildComponentTypeIndex();
 
     for (auto &&object : __childObjects) {
         auto duplicatedChild = object->duplicate(true);
@@ -246,12 +369,40 @@ jleObject::duplicateTemplate(bool childChain)
     return duplicated;
 }
 
+std::shared_ptr<jleObject>
+jleObject::duplicateWithoutChildren(std::size_t childCapacity) const
+{
+    auto duplicated = clone();
+
+    duplicated->__childObjects.clear();
+    duplicated->__childObjects.reserve(childCapacity);
+    duplicated->_parentObject = nullptr;
+    duplicated->_containedInScene = nullptr;
+    duplicated->_instanceID = _instanceIdCounter++;
+    duplicated->_isStarted = false;
+    duplicated->_inSceneObjectList = false;
+    duplicated->_handle = {};
+    duplicated->_transform._owner = duplicated.get();
+    duplicated->_transform._dirty = true;
+
+    duplicated->_components.clear();
+    duplicated->_components.reserve(_components.size());
+    for (auto &&component : _components) {
+        auto clonedComponent = component->clone();
+        clonedComponent->_attachedToObject = duplicated.get();
+        clonedComponent->_containedInScene = nullptr;
+        duplicated->_components.push_back(clonedComponent);
+    }
+    duplicated->rebuildComponentTypeIndex();
+
+    return duplicated;
+}
+
 void
 jleObject::saveAsObjectTemplate()
 {
-    std::ofstream save{jlePath{"GR:otemps/" + _instanceName}.getRealPath() + ".jobj"};
-    cereal::JSONOutputArchive outputArchive(save);
-    outputArchive(shared_from_this());
+    std::ofstream save{jlePath{"GR:otemps/" + _instanceName}.getRealPath() + ".jobj", std::ios::binary};
+    jleSerialization::write(save, shared_from_this());
 }
 
 uint32_t
@@ -260,10 +411,10 @@ jleObject::instanceID() const
     return _instanceID;
 }
 
-uint32_t &
-jleObject::instanceIDRef()
+jleObjectHandle
+jleObject::handle() const
 {
-    return _instanceID;
+    return _handle;
 }
 
 void
@@ -274,6 +425,20 @@ jleObject::tryFindChildWithInstanceId(int instanceId, std::shared_ptr<jleObject>
         return;
     }
 
+    // Look the object up in the scene's index, and check that it lives in this subtree
+    if (_containedInScene) {
+        if (auto found = _containedInScene->findObjectByInstanceId(instanceId)) {
+            for (auto o = found; o; o = o->_parentObject) {
+                if (o == this) {
+                    outObject = found->shared_from_this();
+                    return;
+                }
+            }
+            return;
+        }
+    }
+
+    // Objects that are not registered in a scene, such as templates, are searched recursively
     for (auto &&child : childObjects()) {
         child->tryFindChildWithInstanceId(instanceId, outObject);
     }
@@ -288,7 +453,14 @@ jleObject::getTransform()
 void
 jleObject::propagateOwnedByScene(jleScene *scene)
 {
+    if (_containedInScene && _containedInScene != scene) {
+        _containedInScene->unregisterObject(this);
+    }
     _containedInScene = scene;
+    if (scene) {
+        scene->registerObject(this);
+    }
+
     for (auto child : __childObjects) {
         child->propagateOwnedByScene(scene);
     }
@@ -298,18 +470,13 @@ void
 jleObject::replaceChildrenWithTemplate()
 {
     for (auto &&object : __childObjects) {
-        // Replace child object with template object, if it is based on one
+        // Replace child object with template object, if it is based on one.
+        // Instances of compiled templates already have their nested templates resolved.
         if (object->__templatePath.has_value()) {
-            auto path = object->__templatePath;
-            try {
-                auto original = gCore->resources().loadResourceFromFile<jleObject>(object->__templatePath.value());
-
-                auto copy = original->duplicateTemplate();
-                object = copy;
-
-                object->__templatePath = path;
-            } catch (std::exception &e) {
-                LOGE << "Failed to load object template: " << e.what();
+            if (auto instance = gCore->objectTemplates().instantiate(*object->__templatePath)) {
+                instance->_parentObject = this;
+                object = instance;
+                continue;
             }
         }
 
@@ -320,8 +487,15 @@ jleObject::replaceChildrenWithTemplate()
 void
 jleObject::propagateDestroy()
 {
+    if (_containedInScene) {
+        _containedInScene->unregisterObject(this);
+    }
+
     for (auto &&c : _components) {
         c->onDestroy();
+        if (c->_pool) {
+            c->_pool->remove(c.get());
+        }
     }
 
     for (auto &&o : __childObjects) {
@@ -332,12 +506,105 @@ jleObject::propagateDestroy()
 void
 jleObject::addComponentStart(jleComponent *c)
 {
+    if (_containedInScene && _containedInScene->componentPoolsEnabled() && componentNeedsUpdates(c)) {
+        _containedInScene->componentPool(std::type_index{typeid(*c)}).add(c);
+    }
+
+    if (_sleeping && _containedInScene && componentNeedsUpdates(c)) {
+        _containedInScene->linkAwakeObject(this);
+    }
+
     if (!gEngine->isGameKilled()) {
 
-        if (auto luaComponent = getComponent<cLuaScript>()) {
+        if (auto luaComponent = findComponent<cLuaScript>()) {
             c->registerSelfLua(luaComponent->getSelf());
         }
 
         c->start();
     }
-}
\ No newline at end of file
+}
+void
+jleObject::sleep()
+{
+    if (!_sleeping) {
+        propagateSleeping(true);
+    }
+
+    // The scene stops walking the tree once all of it sleeps
+    auto root = this;
+    while (root->_parentObject) {
+        root = root->_parentObject;
+    }
+    if (_containedInScene && !root->treeNeedsUpdates()) {
+        _containedInScene->unlinkAwakeObject(root);
+    }
+}
+
+void
+jleObject::wake()
+{
+    if (_sleeping) {
+        propagateSleeping(false);
+        if (_containedInScene) {
+            _containedInScene->linkAwakeObject(this);
+        }
+    }
+}
+
+bool
+jleObject::isSleeping() const
+{
+    return _sleeping;
+}
+
+void
+jleObject::propagateSleeping(bool sleeping)
+{
+    _sleeping = sleeping;
+
+    // Only awake components are kept in the scene's pools, so sleeping objects cost nothing per frame
+    if (_containedInScene && _containedInScene->componentPoolsEnabled()) {
+        for (auto &&c : _components) {
+            if (!componentNeedsUpdates(c.get())) {
+                if (c->_pool) {
+                    c->_pool->remove(c.get());
+                }
+            } else if (!c->_pool) {
+                _containedInScene->componentPool(std::type_index{typeid(*c)}).add(c.get());
+            }
+        }
+    }
+
+    for (auto &&child : __childObjects) {
+        child->propagateSleeping(sleeping);
+    }
+}
+
+bool
+jleObject::componentNeedsUpdates(const jleComponent *c) const
+{
+    return c->tickInterval() >= 0.f && (!_sleeping || c->updatesWhileSleeping());
+}
+
+bool
+jleObject::treeNeedsUpdates() const
+{
+    if (!_sleeping || _pendingKill) {
+        return true;
+    }
+
+    if (!_containedInScene || !_containedInScene->componentPoolsEnabled()) {
+        for (auto &&c : _components) {
+            if (componentNeedsUpdates(c.get())) {
+                return true;
+            }
+        }
+    }
+
+    for (auto &&child : __childObjects) {
+        if (child->treeNeedsUpdates()) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -3,12 +3,14 @@
 #ifndef JLE_OBJECT
 #define JLE_OBJECT
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
 
 #include "jleTypeReflectionUtils.h"
 
+#include "jleObjectHandle.h"
 #include "jlePath.h"
 #include "jleSerializedResource.h"
 #include "jleTransform.h"
@@ -19,6 +21,24 @@
 
 class jleScene;
 
+// An object's links in its scene's list of awake objects, see jleScene::updateSceneObjects().
+// Never copied along with the object, a copy is linked on its own.
+struct jleObjectAwakeLink {
+    jleObject *previous{};
+    jleObject *next{};
+    bool linked{false};
+
+    jleObjectAwakeLink() = default;
+
+    jleObjectAwakeLink(const jleObjectAwakeLink &) {}
+
+    jleObjectAwakeLink &
+    operator=(const jleObjectAwakeLink &)
+    {
+        return *this;
+    }
+};
+
 class jleObject : public jleSerializedResource, public std::enable_shared_from_this<jleObject>
 {
     JLE_REGISTER_OBJECT_TYPE(jleObject)
@@ -44,9 +64,8 @@ public:
     saveToFile() override
     {
         if (__templatePath.has_value()) {
-            std::ofstream save{__templatePath->getRealPath()};
-            cereal::JSONOutputArchive outputArchive(save);
-            outputArchive(shared_from_this());
+            std::ofstream save{__templatePath->getRealPath(), std::ios::binary};
+            jleSerialization::write(save, shared_from_this());
         } else {
             LOGE << "Can't save an object that doesn't have a template path set!";
         }
@@ -74,6 +93,10 @@ public:
     template <typename T>
     std::shared_ptr<T> getComponent();
 
+    // Like getComponent(), but without taking a reference, for lookups in hot paths
+    template <typename T>
+    T *findComponent();
+
     template <typename T>
     std::shared_ptr<T> addDependencyComponent(const jleComponent *component);
 
@@ -103,6 +126,8 @@ public:
 
     jleObject *parent();
 
+    // Objects that have handed out weak pointers are never recycled by their scene, since the
+    // pointers would follow the object into its next life. Use handle() where that matters.
     [[nodiscard]] std::weak_ptr<jleObject> weakPtrToThis();
 
     // If this object is based on a template
@@ -110,12 +135,23 @@ public:
 
     uint32_t instanceID() const;
 
-    uint32_t &instanceIDRef();
+    // Handle to this object in its scene, invalid until the object is owned by a scene
+    [[nodiscard]] jleObjectHandle handle() const;
 
     jleTransform &getTransform();
 
+    // Sleeping objects and their children are not updated, and neither are their components,
+    // except those that updatesWhileSleeping(). Moving a sleeping object wakes it up.
+    void sleep();
+
+    void wake();
+
+    [[nodiscard]] bool isSleeping() const;
+
 private:
     friend class jleScene;
+    friend class jleTransform;
+    friend class jleObjectTemplateCache;
 
     explicit jleObject(jleScene *scene);
 
@@ -125,6 +161,9 @@ private:
 
     void replaceChildrenWithTemplate();
 
+    // Copy of this object and its components, with room reserved for the given number of children
+    std::shared_ptr<jleObject> duplicateWithoutChildren(std::size_t childCapacity) const;
+
     void startComponents();
 
     void updateComponents(float dt);
@@ -135,19 +174,58 @@ private:
 
     void updateChildrenEditor(float dt);
 
+    void removePendingKillChildren(bool propagateDestroy);
+
     void addComponentStart(jleComponent *c);
 
+    void propagateSleeping(bool sleeping);
+
+    // If the component should be updated by its scene's component pool or updateComponents()
+    [[nodiscard]] bool componentNeedsUpdates(const jleComponent *c) const;
+
+    // If anything in this object's tree is awake, killed, or has components that update while sleeping
+    // and that aren't updated by the scene's component pools
+    [[nodiscard]] bool treeNeedsUpdates() const;
+
+    // Index into _components of the first component that is an instance of the type, or -1
+    int componentIndexOfType(uint32_t typeId);
+
+    // Adds the last component in _components to the type table
+    void indexLastComponentType();
+
+    void rebuildComponentTypeIndex();
+
     bool _pendingKill = false;
 
     bool _isStarted = false;
 
+    bool _sleeping = false;
+
+    // Set while the object has an entry in its scene's list of root objects.
+    // Re-parented objects keep their entry until the scene compacts the list.
+    bool _inSceneObjectList = false;
+
+    jleObjectAwakeLink _awakeLink{};
+
     uint32_t _instanceID{};
 
+    jleObjectHandle _handle{};
+
 protected:
     friend class jleGame;
     friend class jleLuaEnvironment;
+
+    // Called by resetForReuse(), which every registered object type has and which restores a
+    // destroyed object by assigning it a newly constructed one, so that spawnObject() can reuse
+    // it. Points what the assignment copied from the new object back at this one.
+    void resetObjectForReuse();
+
     std::vector<std::shared_ptr<jleComponent>> _components{};
 
+    // Per component type ID, the index into _components of the first component of that type.
+    // Must be rebuilt whenever components are removed or reordered.
+    std::vector<int> _componentIndexByType{};
+
     jleTransform _transform;
 
     std::vector<std::shared_ptr<jleObject>> __childObjects{};
@@ -156,7 +234,11 @@ protected:
 
     jleScene *_containedInScene = nullptr;
 
-    static inline uint32_t _instanceIdCounter{0};
+    // Set once weakPtrToThis() has been called, see there
+    bool _weakReferenced = false;
+
+    // Atomic since objects are also created by scenes loading on background threads
+    static inline std::atomic<uint32_t> _instanceIdCounter{0};
 };
 
 
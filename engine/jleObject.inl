@@ -27,13 +27,16 @@ jleObject::serialize(Archive &archive)
         child->_parentObject = this;
     }
 
-    // Update the internal world matrix for children
-    getTransform().propagateMatrix();
+    // World matrices of this object and its children are resolved lazily
+    _transform._dirty = false;
+    _transform.flagDirty();
 
     for (auto &&component : _components) {
         component->_attachedToObject = this;
         component->_containedInScene = _containedInScene;
     }
+
+    rebuildComponentTypeIndex();
 }
 template <typename T>
 inline std::shared_ptr<T>
@@ -41,14 +44,23 @@ jleObject::addComponent()
 {
     static_assert(std::is_base_of<jleComponent, T>::value, "T must derive from jleComponent");
 
-    for (auto &component : _components) {
-        if (std::dynamic_pointer_cast<T>(component)) {
-            return std::dynamic_pointer_cast<T>(component);
-        }
+    if (auto existing = getComponent<T>()) {
+        return existing;
     }
 
-    std::shared_ptr<T> newComponent = std::make_shared<T>(this, _containedInScene);
+    std::shared_ptr<T> newComponent;
+    std::shared_ptr<jleComponent> recycled;
+    if (_containedInScene && (recycled = _containedInScene->takeRecycledComponent(std::type_index{typeid(T)}, true))) {
+        recycled->_attachedToObject = this;
+        recycled->_containedInScene = _containedInScene;
+        newComponent = std::static_pointer_cast<T>(recycled);
+    } else if (_containedInScene && _containedInScene->componentPoolsEnabled()) {
+        newComponent = _containedInScene->componentPool<T>().template create<T>(this, _containedInScene);
+    } else {
+        newComponent = std::make_shared<T>(this, _containedInScene);
+    }
     _components.push_back(newComponent);
+    indexLastComponentType();
 
     addComponentStart(newComponent.get());
 
@@ -68,6 +80,7 @@ jleObject::addComponentByName(const std::string &component_name)
     newComponent->_containedInScene = _containedInScene;
 
     _components.push_back(newComponent);
+    indexLastComponentType();
 
     addComponentStart(newComponent.get());
 
@@ -85,6 +98,7 @@ jleObject::addComponent(const std::shared_ptr<T>& component)
     c->_containedInScene = _containedInScene;
 
     _components.push_back(component);
+    indexLastComponentType();
 
     addComponentStart(component.get());
 
@@ -96,15 +110,28 @@ jleObject::getComponent()
 {
     static_assert(std::is_base_of<jleComponent, T>::value, "T must derive from jleComponent");
 
-    for (auto &component : _components) {
-        if (std::dynamic_pointer_cast<T>(component)) {
-            return std::dynamic_pointer_cast<T>(component);
-        }
+    const auto index = componentIndexOfType(jleTypeReflectionUtils::componentTypeId<T>());
+    if (index < 0) {
+        return nullptr;
     }
 
-    return nullptr;
+    return std::static_pointer_cast<T>(_components[index]);
 };
 
+template <typename T>
+inline T *
+jleObject::findComponent()
+{
+    static_assert(std::is_base_of<jleComponent, T>::value, "T must derive from jleComponent");
+
+    const auto index = componentIndexOfType(jleTypeReflectionUtils::componentTypeId<T>());
+    if (index < 0) {
+        return nullptr;
+    }
+
+    return static_cast<T *>(_components[index].get());
+}
+
 template <typename T>
 inline std::shared_ptr<T>
 jleObject::addDependencyComponent(const jleComponent *component)
@@ -0,0 +1,36 @@
+// Copyright (c) 2023. Johan Lind
+
+#ifndef JLE_OBJECTHANDLE_H
+#define JLE_OBJECTHANDLE_H
+
+#include <cstdint>
+
+// Weak reference to an object within a scene, resolved with jleScene::findObject().
+// The slot index is reused once its object is destroyed, but the generation is bumped,
+// so stale handles resolve to nullptr instead of to whatever object took over the slot.
+struct jleObjectHandle {
+    uint32_t index{0};
+
+    // Generation 0 is never handed out, so a default constructed handle is always invalid
+    uint32_t generation{0};
+
+    [[nodiscard]] bool
+    valid() const
+    {
+        return generation != 0;
+    }
+
+    bool
+    operator==(const jleObjectHandle &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool
+    operator!=(const jleObjectHandle &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+#endif // JLE_OBJECTHANDLE_H
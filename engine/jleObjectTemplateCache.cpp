@@ -0,0 +1,112 @@
+// Copyright (c) 2023. Johan Lind
+
+#include "jleObjectTemplateCache.h"
+#include "jleCore.h"
+#include "jleObject.h"
+#include "jleResource.h"
+
+std::shared_ptr<jleObject>
+jleObjectTemplateCache::instantiate(const jlePath &templatePath)
+{
+    const auto compiledTemplate = compiled(templatePath);
+    if (!compiledTemplate) {
+        return nullptr;
+    }
+
+    const auto &nodes = compiledTemplate->nodes;
+
+    std::vector<jleObject *> instantiated;
+    instantiated.reserve(nodes.size());
+
+    std::shared_ptr<jleObject> root;
+    for (auto &&node : nodes) {
+        auto object = node.prototype->duplicateWithoutChildren(node.childCount);
+        object->__templatePath = node.templatePath;
+
+        if (node.parentIndex < 0) {
+            root = object;
+        } else {
+            auto parent = instantiated[node.parentIndex];
+            object->_parentObject = parent;
+            parent->__childObjects.push_back(object);
+        }
+        instantiated.push_back(object.get());
+    }
+
+    return root;
+}
+
+void
+jleObjectTemplateCache::invalidate(const jlePath &templatePath)
+{
+    std::lock_guard lock{_mutex};
+    _compiled.clear();
+    gCore->resources().unloadResource(templatePath);
+}
+
+std::shared_ptr<const jleObjectTemplateCache::jleCompiledObjectTemplate>
+jleObjectTemplateCache::compiled(const jlePath &templatePath)
+{
+    std::lock_guard lock{_mutex};
+
+    auto it = _compiled.find(templatePath);
+    if (it != _compiled.end()) {
+        return it->second;
+    }
+
+    if (!_compiling.insert(templatePath).second) {
+        LOGE << "Object template is nested in itself: " << templatePath.getVirtualPath();
+        return nullptr;
+    }
+
+    auto compiledTemplate = std::make_shared<jleCompiledObjectTemplate>();
+    try {
+        auto original = gCore->resources().loadResourceFromFile<jleObject>(templatePath);
+        if (original) {
+            flatten(original, -1, *compiledTemplate);
+        }
+    } catch (std::exception &e) {
+        LOGE << "Failed to load object template: " << e.what();
+    }
+
+    _compiling.erase(templatePath);
+
+    // Failures are not cached, so that a template that is fixed on disk loads on the next try
+    if (compiledTemplate->nodes.empty()) {
+        LOGE << "Failed to compile object template: " << templatePath.getVirtualPath();
+        return nullptr;
+    }
+
+    compiledTemplate->nodes.front().templatePath = templatePath;
+    _compiled[templatePath] = compiledTemplate;
+    return compiledTemplate;
+}
+
+void
+jleObjectTemplateCache::flatten(const std::shared_ptr<jleObject> &object,
+                                int parentIndex,
+                                jleCompiledObjectTemplate &out)
+{
+    // Nested templates replace the object they are attached to, like jleObject::replaceChildrenWithTemplate()
+    if (parentIndex >= 0 && object->__templatePath.has_value()) {
+        const auto nested = compiled(*object->__templatePath);
+        if (nested) {
+            const int offset = static_cast<int>(out.nodes.size());
+            for (auto &&node : nested->nodes) {
+                auto &copy = out.nodes.emplace_back(node);
+                copy.parentIndex = node.parentIndex < 0 ? parentIndex : node.parentIndex + offset;
+            }
+            return;
+        }
+    }
+
+    const int index = static_cast<int>(out.nodes.size());
+    out.nodes.push_back({object->duplicateWithoutChildren(0),
+                         parentIndex,
+                         static_cast<uint32_t>(object->__childObjects.size()),
+                         object->__templatePath});
+
+    for (auto &&child : object->__childObjects) {
+        flatten(child, index, out);
+    }
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2023. Johan Lind
+
+#pragma once
+
+#include "jlePath.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class jleObject;
+
+// Object templates (.jobj) compiled to a flat list of objects, with nested templates already
+// resolved. Instantiating one copies the list in order into storage reserved up front, instead
+// of loading and deep cloning each nested template again.
+class jleObjectTemplateCache
+{
+public:
+    // New object tree from the template, not yet owned by a scene. Nullptr if it can't be loaded.
+    std::shared_ptr<jleObject> instantiate(const jlePath &templatePath);
+
+    // Drops the compiled template and its loaded file, so that the next instantiation reads it again.
+    // All compiled templates are dropped, since any of them could have the changed one nested.
+    void invalidate(const jlePath &templatePath);
+
+private:
+    struct jleCompiledObjectTemplate {
+        struct Node {
+            // Copy of the object and its components, without children
+            std::shared_ptr<jleObject> prototype;
+            int parentIndex;
+            uint32_t childCount;
+            std::optional<jlePath> templatePath;
+        };
+
+        // Parents always come before their children
+        std::vector<Node> nodes;
+    };
+
+    std::shared_ptr<const jleCompiledObjectTemplate> compiled(const jlePath &templatePath);
+
+    void flatten(const std::shared_ptr<jleObject> &object, int parentIndex, jleCompiledObjectTemplate &out);
+
+    // Recursive since compiling a template compiles the templates nested in it.
+    // Scenes can also be loaded on background threads.
+    std::recursive_mutex _mutex;
+
+    std::unordered_map<jlePath, std::shared_ptr<const jleCompiledObjectTemplate>> _compiled;
+
+    // Templates being compiled, to catch templates nested in themselves
+    std::unordered_set<jlePath> _compiling;
+};
@@ -29,18 +29,27 @@ jlePhysics::jlePhysics()
 }
 
 void
-jlePhysics::step(float dt)
+jlePhysics::step(float dt, bool fixedStep)
 {
     JLE_SCOPE_PROFILE_CPU(physics)
 
-    _dynamicsWorld->stepSimulation(dt);
+    if (fixedStep) {
+        _dynamicsWorld->stepSimulation(dt, 1, dt);
+    } else {
+        _dynamicsWorld->stepSimulation(dt);
+    }
 
-    // Update jle objects to new transforms
+    // Update jle objects to new transforms. Only bodies the simulation moved are written back,
+    // since setting the transform wakes the object up and would keep resting objects from sleeping.
     for (int j = _dynamicsWorld->getNumCollisionObjects() - 1; j >= 0; j--) {
         btCollisionObject *obj = _dynamicsWorld->getCollisionObjectArray()[j];
         btRigidBody *body = btRigidBody::upcast(obj);
+        if (!body || body->isStaticOrKinematicObject() || !body->isActive()) {
+            continue;
+        }
+
         btTransform trans;
-        if (body && body->getMotionState()) {
+        if (body->getMotionState()) {
             body->getMotionState()->getWorldTransform(trans);
         } else {
             trans = obj->getWorldTransform();
@@ -22,7 +22,8 @@ class jlePhysics
 public:
     jlePhysics();
 
-    void step(float dt);
+    // With fixedStep, dt is simulated as exactly one substep instead of in 1/60 s substeps
+    void step(float dt, bool fixedStep = false);
 
     btRigidBody* createRigidbody(float mass, const btTransform& startTransform, btCollisionShape* shape, cRigidbody* jleRigidbody);
 
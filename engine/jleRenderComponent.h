@@ -0,0 +1,19 @@
+// Copyright (c) 2023. Johan Lind
+
+#pragma once
+
+#include "jleComponent.h"
+
+// Base of components that send what they draw to jleRendering in update(). What is sent is
+// cleared every frame, so they keep updating while their object sleeps, see jleObject::sleep().
+class jleRenderComponent : public jleComponent
+{
+public:
+    using jleComponent::jleComponent;
+
+    [[nodiscard]] bool
+    updatesWhileSleeping() const final
+    {
+        return true;
+    }
+};
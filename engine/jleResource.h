@@ -4,13 +4,17 @@
 
 #include "jlePath.h"
 #include "jleResourceInterface.h"
+#include "jleSerializationFormat.h"
 #include "jleSerializedResource.h"
 #include <plog/Log.h>
 
 #include <chrono>
+#include <deque>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <typeinfo>
@@ -18,6 +22,7 @@
 #include <vector>
 
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 #include <cereal/cereal.hpp>
 #include <cereal/types/memory.hpp>
 #include <cereal/types/polymorphic.hpp>
@@ -32,7 +37,8 @@ public:
     jleResources &operator=(jleResources &&) = delete;
 
     // Gets a shared_ptr to a resource from file, or a shared_ptr to an already
-    // loaded copy of that resource
+    // loaded copy of that resource. From a background thread, resources that require the main
+    // thread are returned before they are loaded, see isLoaded().
     template <typename T>
     std::shared_ptr<T>
     loadResourceFromFile(const jlePath &path, const bool forceReload = false)
@@ -42,6 +48,7 @@ public:
         const auto prefix = path.getPathPrefix();
 
         if (!forceReload) {
+            std::lock_guard lock{_resourcesMutex};
             auto it = _resources[prefix].find(path);
             if (it != _resources[prefix].end()) {
                 if(it->second.first == typeid(T).hash_code())
@@ -61,11 +68,10 @@ public:
         if constexpr (std::is_base_of<jleSerializedResource, T>::value) {
             if (newResource->getFileExtension() == path.getFileEnding()) {
                 try {
-                    std::ifstream i(path.getRealPath());
-                    cereal::JSONInputArchive iarchive{i};
+                    std::ifstream i(path.getRealPath(), std::ios::binary);
                     std::shared_ptr<jleSerializedResource> sr =
                         std::static_pointer_cast<jleSerializedResource>(newResource);
-                    iarchive(sr);
+                    jleSerialization::read(i, sr);
                     newResource = sr;
                     loadSuccess = jleLoadFromFileSuccessCode::SUCCESS;
                 } catch (std::exception &e) {
@@ -75,10 +81,27 @@ public:
             }
         }
 
-        loadSuccess = newResource->loadFromFile(path);
+        if (newResource->requiresMainThreadLoad() && !isMainThread()) {
+            // Cached right away so that other loads share it, and evicted again if the main
+            // thread fails to load it, so that the next load retries instead of getting the failure
+            runOnMainThread(newResource.get(), [this, newResource, path, prefix]() {
+                if (newResource->loadFromFile(path) == jleLoadFromFileSuccessCode::FAIL) {
+                    LOGW << "Failed to load: " << path.getVirtualPath();
+                    std::lock_guard lock{_resourcesMutex};
+                    auto it = _resources[prefix].find(path);
+                    if (it != _resources[prefix].end() && it->second.second == newResource) {
+                        _resources[prefix].erase(it);
+                    }
+                }
+            });
+            loadSuccess = jleLoadFromFileSuccessCode::SUCCESS;
+        } else {
+            loadSuccess = newResource->loadFromFile(path);
+        }
 
         newResource->filepath = path.getRealPath();
 
+        std::lock_guard lock{_resourcesMutex};
         _resources[prefix].erase(path);
         if (loadSuccess == jleLoadFromFileSuccessCode::SUCCESS) {
             _resources[prefix].insert(std::make_pair(path, std::make_pair(typeid(T).hash_code(), newResource)));
@@ -96,14 +119,14 @@ public:
     {
         jlePath path = jlePath{resource->filepath, false};
         try {
-            std::ifstream i(path.getRealPath());
+            std::ifstream i(path.getRealPath(), std::ios::binary);
             std::shared_ptr<jleSerializedResource> f = std::const_pointer_cast<jleSerializedResource>(resource);
-            cereal::JSONInputArchive archive{i};
-            archive(f);
+            jleSerialization::read(i, f);
             f->loadFromFile(path);
 
             const auto prefix = path.getPathPrefix();
 
+            std::lock_guard lock{_resourcesMutex};
             _resources[prefix].erase(path);
             _resources[prefix].insert(std::make_pair(path, std::make_pair(typeid(resource).hash_code(), resource)));
         } catch (std::exception &e) {
@@ -119,6 +142,7 @@ public:
         std::shared_ptr<jleSerializedResource> ptr{};
 
         if (!forceReload) {
+            std::lock_guard lock{_resourcesMutex};
             auto it = _resources[prefix].find(path);
             if (it != _resources[prefix].end()) {
                 return std::static_pointer_cast<jleSerializedResource>(it->second.second);
@@ -126,9 +150,8 @@ public:
         }
 
         try {
-            std::ifstream i(path.getRealPath());
-            cereal::JSONInputArchive iarchive{i};
-            iarchive(ptr);
+            std::ifstream i(path.getRealPath(), std::ios::binary);
+            jleSerialization::read(i, ptr);
 
             ptr->filepath = path.getRealPath();
 
@@ -136,6 +159,7 @@ public:
                 LOGE << "Failed loading serialized resource's internals";
             }
 
+            std::lock_guard lock{_resourcesMutex};
             _resources[prefix].erase(path);
             _resources[prefix].insert(std::make_pair(path, std::make_pair(typeid(ptr).hash_code(), ptr)));
 
@@ -153,6 +177,7 @@ public:
     {
         const auto prefix = path.getPathPrefix();
 
+        std::lock_guard lock{_resourcesMutex};
         _resources[prefix].erase(path);
         _resources[prefix].insert(std::make_pair(path, resource));
 
@@ -165,6 +190,7 @@ public:
     resource(const jlePath &path)
     {
         const auto prefix = path.getPathPrefix();
+        std::lock_guard lock{_resourcesMutex};
         return std::static_pointer_cast<T>(_resources[prefix].at(path));
     }
 
@@ -172,6 +198,7 @@ public:
     resource(const jlePath &path)
     {
         const auto prefix = path.getPathPrefix();
+        std::lock_guard lock{_resourcesMutex};
         return _resources[prefix].at(path).second;
     }
 
@@ -180,11 +207,20 @@ public:
     isResourceLoaded(const jlePath &path)
     {
         const auto prefix = path.getPathPrefix();
+        std::lock_guard lock{_resourcesMutex};
         auto it = _resources[prefix].find(path);
         if (it == _resources[prefix].end()) {
             return false;
         }
-        return true;
+        return _pendingMainThreadLoads.find(it->second.second.get()) == _pendingMainThreadLoads.end();
+    }
+
+    // False while work queued for the resource with runOnMainThread() hasn't run yet
+    bool
+    isLoaded(const jleResourceInterface &resource)
+    {
+        std::lock_guard lock{_resourcesMutex};
+        return _pendingMainThreadLoads.find(&resource) == _pendingMainThreadLoads.end();
     }
 
     // Unload all resources from in-memory in the given drive.
@@ -192,6 +228,7 @@ public:
     void
     unloadAllResources(const std::string &drive)
     {
+        std::lock_guard lock{_resourcesMutex};
         LOG_VERBOSE << "Unloading in-memory file resources on drive " << drive << ' ' << _resources[drive].size();
         _resources[drive].clear();
     }
@@ -199,9 +236,64 @@ public:
     void
     unloadResource(const jlePath &path)
     {
+        std::lock_guard lock{_resourcesMutex};
         _resources[path.getPathPrefix()].erase(path);
     }
 
+    // Queues work that has to run on the main thread, such as OpenGL uploads for resources
+    // loaded on a background thread. Tasks run in the order they were queued.
+    void
+    runOnMainThread(std::function<void()> task)
+    {
+        std::lock_guard lock{_mainThreadTasksMutex};
+        _mainThreadTasks.push_back(std::move(task));
+    }
+
+    // Queues work that finishes loading the resource, which isn't loaded until it has run
+    void
+    runOnMainThread(const jleResourceInterface *resource, std::function<void()> task)
+    {
+        {
+            std::lock_guard lock{_resourcesMutex};
+            _pendingMainThreadLoads[resource]++;
+        }
+        runOnMainThread([this, resource, task = std::move(task)]() {
+            task();
+            std::lock_guard lock{_resourcesMutex};
+            auto it = _pendingMainThreadLoads.find(resource);
+            if (--it->second == 0) {
+                _pendingMainThreadLoads.erase(it);
+            }
+        });
+    }
+
+    // Runs queued main thread tasks until the queue is empty or the time budget is spent.
+    // At least one task runs per call, so that a single slow task can't stall the queue.
+    void
+    processMainThreadTasks(float budgetMilliseconds)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto budget = std::chrono::duration<float, std::milli>(budgetMilliseconds);
+        do {
+            std::function<void()> task;
+            {
+                std::lock_guard lock{_mainThreadTasksMutex};
+                if (_mainThreadTasks.empty()) {
+                    return;
+                }
+                task = std::move(_mainThreadTasks.front());
+                _mainThreadTasks.pop_front();
+            }
+            task();
+        } while (std::chrono::steady_clock::now() - start < budget);
+    }
+
+    [[nodiscard]] bool
+    isMainThread() const
+    {
+        return std::this_thread::get_id() == _mainThreadId;
+    }
+
     using TypeHash = std::size_t;
 
     const std::unordered_map<std::string, std::unordered_map<jlePath, std::pair<TypeHash, std::shared_ptr<jleResourceInterface>>>> &
@@ -216,11 +308,29 @@ private:
     std::unordered_map<std::string, std::unordered_map<jlePath, std::pair<TypeHash, std::shared_ptr<jleResourceInterface>>>>
         _resources{};
 
+    // Guards _resources, since scenes can be loaded on background threads.
+    // Recursive since destroying a resource during clean up may unload others.
+    std::recursive_mutex _resourcesMutex;
+
+    // Resources with main thread tasks left to run, and how many. Also guarded by _resourcesMutex.
+    std::unordered_map<const jleResourceInterface *, int> _pendingMainThreadLoads;
+
+    // Created by jleCore, on the main thread
+    const std::thread::id _mainThreadId{std::this_thread::get_id()};
+
+    std::mutex _mainThreadTasksMutex;
+    std::deque<std::function<void()>> _mainThreadTasks;
+
     static inline int _periodicCleanCounter{0};
 
     void
     periodicResourcesCleanUp()
     {
+        // Resources may own GPU objects, so they are only ever destroyed on the main thread
+        if (!isMainThread()) {
+            return;
+        }
+
         // Clean every 10th time that this method is called
         if (++_periodicCleanCounter % 10 == 0) {
             std::vector<jlePath> keys_for_removal;
@@ -0,0 +1,109 @@
+// Copyright (c) 2023. Johan Lind
+
+#include "jleResourceConverter.h"
+#include "jleObject.h"
+#include "jlePathDefines.h"
+#include "jleSerializedResource.h"
+#include "jleTypeReflectionUtils.h"
+
+#include <plog/Log.h>
+
+#include <fstream>
+#include <utility>
+
+namespace
+{
+template <typename T>
+bool
+convertSerialized(const std::filesystem::path &file,
+                  const std::filesystem::path &output,
+                  jleSerializationFormat targetFormat)
+{
+    std::shared_ptr<T> resource;
+    {
+        std::ifstream i(file, std::ios::binary);
+        if (jleSerialization::read(i, resource) == targetFormat) {
+            return false;
+        }
+    }
+
+    std::ofstream o(output, std::ios::binary | std::ios::trunc);
+    jleSerialization::write(o, resource, targetFormat);
+    return true;
+}
+} // namespace
+
+jleResourceConverter::jleResourceConverter(jleSerializationFormat targetFormat, std::filesystem::path outputDirectory)
+    : _targetFormat{targetFormat}, _outputDirectory{std::move(outputDirectory)}
+{
+}
+
+void
+jleResourceConverter::convertAll()
+{
+    if (_outputDirectory.empty()) {
+        LOGE << "No output directory to convert resources to";
+        return;
+    }
+
+    convertDirectory(GAME_RESOURCES_DIRECTORY, _outputDirectory / "GameResources");
+    convertDirectory(JLE_ENGINE_RESOURCES_PATH, _outputDirectory / "EngineResources");
+
+    LOGI << "Converted " << _convertedCount << " serialized resources to "
+         << (_targetFormat == jleSerializationFormat::Binary ? "binary" : "JSON");
+}
+
+void
+jleResourceConverter::convertDirectory(const std::filesystem::path &directory,
+                                       const std::filesystem::path &outputDirectory)
+{
+    if (!std::filesystem::is_directory(directory)) {
+        LOGW << "Can't convert resources in " << directory.string() << ", not a directory";
+        return;
+    }
+
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+
+        const auto output = outputDirectory / std::filesystem::relative(entry.path(), directory);
+        std::filesystem::create_directories(output.parent_path());
+        if (convertFile(entry.path(), output)) {
+            _convertedCount++;
+        } else {
+            std::filesystem::copy_file(entry.path(), output, std::filesystem::copy_options::overwrite_existing);
+        }
+    }
+}
+
+bool
+jleResourceConverter::convertFile(const std::filesystem::path &file, const std::filesystem::path &output)
+{
+    std::string extension = file.extension().string();
+    if (extension.empty()) {
+        return false;
+    }
+    extension.erase(0, 1);
+
+    try {
+        // Object templates are saved through their jleObject pointer, not as a registered resource
+        if (extension == "jobj") {
+            return convertSerialized<jleObject>(file, output, _targetFormat);
+        }
+
+        for (auto &&[name, data] : jleTypeReflectionUtils::registeredResourcesRef()) {
+            if (data.filenameExtension != extension) {
+                continue;
+            }
+            if (!std::dynamic_pointer_cast<jleSerializedResource>(data.creationFunction())) {
+                return false;
+            }
+            return convertSerialized<jleSerializedResource>(file, output, _targetFormat);
+        }
+    } catch (std::exception &e) {
+        LOGE << "Failed converting " << file.string() << " - " << e.what();
+    }
+
+    return false;
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2023. Johan Lind
+
+#pragma once
+
+#include "jleSerializationFormat.h"
+
+#include <filesystem>
+
+// Writes a copy of the resources with the serialized ones (scenes, object templates, materials, ...)
+// in another format. Used to ship binary resources, while the editor keeps working on JSON.
+// Requires a running jleCore, since deserializing a resource also loads the resources it references.
+class jleResourceConverter
+{
+public:
+    jleResourceConverter(jleSerializationFormat targetFormat, std::filesystem::path outputDirectory);
+
+    // Writes the game and engine resource directories to GameResources and EngineResources
+    // in the output directory
+    void convertAll();
+
+    // Writes all files in the directory, recursively, to the same paths in the output directory.
+    // Files that have a serialized resource's extension are converted, others are copied.
+    void convertDirectory(const std::filesystem::path &directory, const std::filesystem::path &outputDirectory);
+
+    // False if the file is not a serialized resource, is already in the format, or fails to load
+    bool convertFile(const std::filesystem::path &file, const std::filesystem::path &output);
+
+private:
+    jleSerializationFormat _targetFormat;
+
+    std::filesystem::path _outputDirectory;
+
+    int _convertedCount{0};
+};
@@ -8,6 +8,7 @@
 #include <string>
 #include "jleCompileHelper.h"
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 #include <cereal/cereal.hpp>
 #include <cereal/types/polymorphic.hpp>
 #include <plog/Log.h>
@@ -30,6 +31,15 @@ public:
         return jleLoadFromFileSuccessCode::FAIL;
     };
 
+    // Resources that create OpenGL objects or run Lua in loadFromFile() must return true.
+    // When such a resource is loaded from a background thread, jleResources defers the
+    // loadFromFile() call to the main thread.
+    [[nodiscard]] virtual bool
+    requiresMainThreadLoad() const
+    {
+        return false;
+    }
+
     // Optionally implement logic for saving data to file
     [[maybe_unused]] virtual void saveToFile(){};
 
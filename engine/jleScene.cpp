@@ -1,7 +1,9 @@
 // Copyright (c) 2023. Johan Lind
 
 #include "jleScene.h"
+#include "jleComponent.h"
 #include "jleGameEngine.h"
+#include "jleJobSystem.h"
 #include "jleObject.h"
 #include "jleProfiler.h"
 
@@ -10,11 +12,10 @@
 
 JLE_EXTERN_TEMPLATE_CEREAL_CPP(jleScene)
 
-int jleScene::_scenesCreatedCount{0};
+std::atomic<int> jleScene::_scenesCreatedCount{0};
 
 jleScene::jleScene() {
-    sceneName = "Scene_" + std::to_string(_scenesCreatedCount);
-    _scenesCreatedCount++;
+    sceneName = "Scene_" + std::to_string(_scenesCreatedCount++);
 }
 
 jleScene::jleScene(const std::string &sceneName) {
@@ -24,16 +25,277 @@ jleScene::jleScene(const std::string &sceneName) {
 
 void jleScene::updateSceneObjects(float dt) {
     JLE_SCOPE_PROFILE_CPU(jleScene_updateSceneObjects)
-    for (int32_t i = _sceneObjects.size() - 1; i >= 0; i--) {
-        if (_sceneObjects[i]->_pendingKill) {
-            _sceneObjects[i]->propagateDestroy();
-            _sceneObjects.erase(_sceneObjects.begin() + i);
+
+    resolveWorldTransforms();
+
+    if (_componentPoolsEnabled) {
+        updateComponentPoolsParallel(dt);
+    }
+
+    // Trees that sleep entirely are not in the list, so they cost nothing here
+    _updatingSceneObjects = true;
+    for (jleObject *object = _awakeObjects; object; object = _nextAwakeObject) {
+        _nextAwakeObject = object->_awakeLink.next;
+
+        // Killed objects are removed in one pass after the loop
+        if (object->_pendingKill) {
+            _sceneObjectsNeedCompaction = true;
+            continue;
+        }
+
+        if (!object->_sleeping) {
+            object->update(dt);
+        }
+        if (!_componentPoolsEnabled) {
+            object->updateComponents(dt);
+        }
+        object->updateChildren(dt);
+    }
+    _nextAwakeObject = nullptr;
+    _updatingSceneObjects = false;
+
+    if (_sceneObjectsNeedCompaction) {
+        compactSceneObjects(true, true);
+    }
+
+    if (_componentPoolsEnabled) {
+        updateComponentPools(dt);
+    }
+}
+
+void
+jleScene::compactSceneObjects(bool removePendingKill, bool propagateDestroy)
+{
+    // Indexed, since onDestroy() may detach objects and push them to the back
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < _sceneObjects.size(); i++) {
+        auto object = _sceneObjects[i];
+
+        if (object->_parentObject) {
+            object->_inSceneObjectList = false;
+            unlinkAwakeObject(object.get());
+            continue;
+        }
+
+        if (object->_pendingKill && removePendingKill) {
+            object->_inSceneObjectList = false;
+            if (propagateDestroy) {
+                object->propagateDestroy();
+                _sceneObjects[i] = nullptr;
+                recycleObject(std::move(object));
+            } else {
+                unregisterObjectTree(object.get());
+            }
             continue;
         }
 
-        _sceneObjects[i]->update(dt);
-        _sceneObjects[i]->updateComponents(dt);
-        _sceneObjects[i]->updateChildren(dt);
+        _sceneObjects[kept++] = std::move(object);
+    }
+    _sceneObjects.resize(kept);
+
+    // Killed objects that were kept are flagged again by the next update loop
+    _sceneObjectsNeedCompaction = false;
+}
+
+void
+jleScene::registerObject(jleObject *object)
+{
+    auto handle = object->_handle;
+    if (handle.valid() && handle.index < _objectSlots.size() && _objectSlots[handle.index].object == object) {
+        return;
+    }
+
+    _objectsByInstanceId[object->_instanceID] = object;
+
+    if (_freeObjectSlots.empty()) {
+        _freeObjectSlots.push_back(static_cast<uint32_t>(_objectSlots.size()));
+        _objectSlots.emplace_back();
+    }
+
+    const auto index = _freeObjectSlots.back();
+    _freeObjectSlots.pop_back();
+
+    auto &slot = _objectSlots[index];
+    slot.object = object;
+    object->_handle = jleObjectHandle{index, slot.generation};
+}
+
+void
+jleScene::unregisterObject(jleObject *object)
+{
+    unlinkAwakeObject(object);
+
+    const auto handle = object->_handle;
+    if (!handle.valid() || handle.index >= _objectSlots.size()) {
+        return;
+    }
+
+    auto &slot = _objectSlots[handle.index];
+    if (slot.object != object || slot.generation != handle.generation) {
+        return;
+    }
+
+    auto it = _objectsByInstanceId.find(object->_instanceID);
+    if (it != _objectsByInstanceId.end() && it->second == object) {
+        _objectsByInstanceId.erase(it);
+    }
+
+    slot.object = nullptr;
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    _freeObjectSlots.push_back(handle.index);
+
+    object->_handle = {};
+}
+
+void
+jleScene::unregisterObjectTree(jleObject *object)
+{
+    unregisterObject(object);
+    for (auto &&child : object->__childObjects) {
+        unregisterObjectTree(child.get());
+    }
+}
+
+void
+jleScene::linkAwakeObject(jleObject *object)
+{
+    while (object->_parentObject) {
+        object = object->_parentObject;
+    }
+
+    // Objects not yet in the scene's root objects are linked when they are added
+    auto &link = object->_awakeLink;
+    if (link.linked || !object->_inSceneObjectList) {
+        return;
+    }
+
+    link.previous = nullptr;
+    link.next = _awakeObjects;
+    if (_awakeObjects) {
+        _awakeObjects->_awakeLink.previous = object;
+    }
+    _awakeObjects = object;
+    link.linked = true;
+}
+
+void
+jleScene::unlinkAwakeObject(jleObject *root)
+{
+    auto &link = root->_awakeLink;
+    if (!link.linked) {
+        return;
+    }
+
+    if (_nextAwakeObject == root) {
+        _nextAwakeObject = link.next;
+    }
+    if (link.previous) {
+        link.previous->_awakeLink.next = link.next;
+    } else {
+        _awakeObjects = link.next;
+    }
+    if (link.next) {
+        link.next->_awakeLink.previous = link.previous;
+    }
+    link.linked = false;
+    link.previous = nullptr;
+    link.next = nullptr;
+}
+
+jleObject *
+jleScene::findObject(jleObjectHandle handle) const
+{
+    if (handle.index >= _objectSlots.size()) {
+        return nullptr;
+    }
+
+    const auto &slot = _objectSlots[handle.index];
+    if (slot.generation != handle.generation) {
+        return nullptr;
+    }
+    return slot.object;
+}
+
+jleObject *
+jleScene::findObjectByInstanceId(uint32_t instanceId) const
+{
+    auto it = _objectsByInstanceId.find(instanceId);
+    if (it == _objectsByInstanceId.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void
+jleScene::resolveWorldTransforms()
+{
+    if (!_dirtyTransforms) {
+        return;
+    }
+
+    JLE_SCOPE_PROFILE_CPU(jleScene_resolveWorldTransforms)
+
+    // The order array doubles as the breadth-first queue
+    auto &order = _transformResolveOrder;
+    order.clear();
+    for (auto &&object : _sceneObjects) {
+        // Re-parented objects are reached through their new parent
+        if (!object->_parentObject) {
+            order.push_back(object.get());
+        }
+    }
+
+    for (std::size_t i = 0; i < order.size(); i++) {
+        auto object = order[i];
+        object->_transform.resolveFromResolvedParent();
+        for (auto &&child : object->__childObjects) {
+            order.push_back(child.get());
+        }
+    }
+
+    _dirtyTransforms = false;
+}
+
+void
+jleScene::notifyTransformChanges()
+{
+    if (_transformChangedObjects.empty()) {
+        return;
+    }
+
+    JLE_SCOPE_PROFILE_CPU(jleScene_notifyTransformChanges)
+
+    // Swapped out, since components may move objects again while being notified
+    std::swap(_transformChangedObjects, _transformChangedObjectsNotifying);
+    for (auto handle : _transformChangedObjectsNotifying) {
+        if (auto object = findObject(handle)) {
+            for (auto &&component : object->_components) {
+                component->onTransformChanged();
+            }
+        }
+    }
+    _transformChangedObjectsNotifying.clear();
+}
+
+void
+jleScene::updateComponentPoolsParallel(float dt)
+{
+    JLE_SCOPE_PROFILE_CPU(jleScene_updateComponentPoolsParallel)
+    for (auto &&pool : _componentPools) {
+        if (pool->hasParallelUpdate()) {
+            pool->parallelUpdate(dt, gCore->jobSystem());
+        }
+    }
+}
+
+void
+jleScene::updateComponentPools(float dt)
+{
+    JLE_SCOPE_PROFILE_CPU(jleScene_updateComponentPools)
+    for (auto &&pool : _componentPools) {
+        pool->update(dt);
     }
 }
 
@@ -42,9 +304,10 @@ jleScene::updateSceneObejctsEditor(float dt)
 {
 
     JLE_SCOPE_PROFILE_CPU(jleScene_updateSceneObejctsEditor)
+    _updatingSceneObjects = true;
     for (int32_t i = _sceneObjects.size() - 1; i >= 0; i--) {
-        if (_sceneObjects[i]->_pendingKill) {
-            _sceneObjects.erase(_sceneObjects.begin() + i);
+        if (_sceneObjects[i]->_pendingKill || _sceneObjects[i]->_parentObject) {
+            _sceneObjectsNeedCompaction = true;
             continue;
         }
 
@@ -52,13 +315,23 @@ jleScene::updateSceneObejctsEditor(float dt)
         _sceneObjects[i]->updateComponentsEditor(dt);
         _sceneObjects[i]->updateChildrenEditor(dt);
     }
+    _updatingSceneObjects = false;
 
+    if (_sceneObjectsNeedCompaction) {
+        compactSceneObjects(true, false);
+    }
+
+    notifyTransformChanges();
 }
 
 void jleScene::processNewSceneObjects() {
     JLE_SCOPE_PROFILE_CPU(jleScene_processNewSceneObjects)
     if (!_newSceneObjects.empty()) {
         for (const auto &newObject : _newSceneObjects) {
+            if (_componentPoolsEnabled) {
+                moveComponentsToPools(newObject.get());
+            }
+
             if (!newObject->_isStarted) {
                 if(!gEngine->isGameKilled())
                 {
@@ -71,9 +344,12 @@ void jleScene::processNewSceneObjects() {
             // Only push back objects existing directly in the scene into scene
             // objects The object can be placed as a child object in another
             // object, and thus no longer existing directly in the scene
-            if (newObject->_parentObject == nullptr) {
+            if (newObject->_parentObject == nullptr && !newObject->_inSceneObjectList) {
                 _sceneObjects.push_back(newObject);
+                newObject->_inSceneObjectList = true;
+                linkAwakeObject(newObject.get());
             }
+            _dirtyTransforms = true;
         }
 
         _newSceneObjects.clear();
@@ -87,10 +363,14 @@ void jleScene::destroyScene() {
 
 void jleScene::configurateSpawnedObject(const std::shared_ptr<jleObject> &obj) {
     obj->_containedInScene = this;
-    obj->_instanceName = std::string{obj->objectNameVirtual()} + "_" +
-                         std::to_string(obj->_instanceID);
+
+    // Built in place, so that a recycled object reuses its name's storage
+    obj->_instanceName.assign(obj->objectNameVirtual());
+    obj->_instanceName += '_';
+    obj->_instanceName += std::to_string(obj->_instanceID);
 
     obj->replaceChildrenWithTemplate();
+    obj->propagateOwnedByScene(this);
     _newSceneObjects.push_back(obj);
 }
 
@@ -99,6 +379,9 @@ jleScene::startObjects()
 {
     for(auto&& o : _sceneObjects)
     {
+        if (_componentPoolsEnabled) {
+            moveComponentsToPools(&*o);
+        }
         startObject(&*o);
     }
 }
@@ -129,6 +412,173 @@ jleScene::spawnObject(std::shared_ptr<jleObject> object)
     configurateSpawnedObject(object);
 }
 
+void
+jleScene::setComponentPoolsEnabled(bool enabled)
+{
+    _componentPoolsEnabled = enabled;
+}
+
+bool
+jleScene::componentPoolsEnabled() const
+{
+    return _componentPoolsEnabled;
+}
+
+void
+jleScene::setObjectRecyclingEnabled(bool enabled)
+{
+    _objectRecyclingEnabled = enabled;
+    if (!enabled) {
+        _recycledObjects.clear();
+        _recycledComponents.clear();
+    }
+}
+
+bool
+jleScene::objectRecyclingEnabled() const
+{
+    return _objectRecyclingEnabled;
+}
+
+void
+jleScene::recycleObject(std::shared_ptr<jleObject> object)
+{
+    // Objects still referenced elsewhere, for example from Lua or through a weak pointer,
+    // are left as they are
+    if (!_objectRecyclingEnabled || object.use_count() != 1 || object->_weakReferenced) {
+        return;
+    }
+
+    for (auto &&child : object->__childObjects) {
+        recycleObject(std::move(child));
+    }
+    object->__childObjects.clear();
+
+    for (auto &&component : object->_components) {
+        if (component.use_count() == 1) {
+            auto &recycled = _recycledComponents[std::type_index{typeid(*component)}];
+            if (recycled.size() < _maxRecycledPerType) {
+                recycled.push_back(std::move(component));
+            }
+        }
+    }
+    object->_components.clear();
+
+    auto &recycled = _recycledObjects[std::type_index{typeid(*object)}];
+    if (recycled.size() < _maxRecycledPerType) {
+        recycled.push_back(std::move(object));
+    }
+}
+
+std::shared_ptr<jleObject>
+jleScene::takeRecycledObject(std::type_index objectType, bool reset)
+{
+    if (!_objectRecyclingEnabled) {
+        return nullptr;
+    }
+
+    auto it = _recycledObjects.find(objectType);
+    if (it == _recycledObjects.end() || it->second.empty()) {
+        return nullptr;
+    }
+
+    // All instances in a list have the same type, if one can't reset itself none can
+    if (reset && !it->second.back()->resetForReuse()) {
+        return nullptr;
+    }
+
+    auto object = std::move(it->second.back());
+    it->second.pop_back();
+    return object;
+}
+
+std::shared_ptr<jleComponent>
+jleScene::takeRecycledComponent(std::type_index componentType, bool reset)
+{
+    if (!_objectRecyclingEnabled) {
+        return nullptr;
+    }
+
+    auto it = _recycledComponents.find(componentType);
+    if (it == _recycledComponents.end() || it->second.empty()) {
+        return nullptr;
+    }
+
+    if (reset) {
+        auto &component = it->second.back();
+        if (!component->resetForReuse()) {
+            return nullptr;
+        }
+        component->_timeSinceTick = 0.f;
+    }
+
+    auto component = std::move(it->second.back());
+    it->second.pop_back();
+    return component;
+}
+
+std::shared_ptr<jleObject>
+jleScene::cloneObject(const jleObject &source)
+{
+    if (auto recycled = takeRecycledObject(std::type_index{typeid(source)})) {
+        recycled->copyFrom(source);
+        return recycled;
+    }
+    return source.clone();
+}
+
+std::shared_ptr<jleComponent>
+jleScene::cloneComponent(const jleComponent &source)
+{
+    if (auto recycled = takeRecycledComponent(std::type_index{typeid(source)})) {
+        recycled->copyFrom(source);
+        return recycled;
+    }
+    return source.clone();
+}
+
+jleComponentPool &
+jleScene::componentPool(std::type_index componentType)
+{
+    auto it = _componentPoolsLookup.find(componentType);
+    if (it != _componentPoolsLookup.end()) {
+        return *it->second;
+    }
+
+    auto &pool = _componentPools.emplace_back(std::make_unique<jleComponentPool>());
+    _componentPoolsLookup.emplace(componentType, pool.get());
+    return *pool;
+}
+
+void
+jleScene::moveComponentsToPools(jleObject *o)
+{
+    for (auto &component : o->_components) {
+        if (component->_pool) {
+            continue;
+        }
+
+        auto &pool = componentPool(std::type_index{typeid(*component)});
+
+        // Components that were deserialized or cloned have not been started yet,
+        // so they can be relocated into the pool's contiguous storage
+        if (!component->_poolAllocated && !o->_isStarted) {
+            auto pooled = component->clonePooled(pool);
+            pooled->_attachedToObject = o;
+            pooled->_containedInScene = this;
+            component = pooled;
+        }
+
+        if (o->componentNeedsUpdates(component.get())) {
+            pool.add(component.get());
+        }
+    }
+
+    for (auto &&child : o->__childObjects) {
+        moveComponentsToPools(child.get());
+    }
+}
+
 std::shared_ptr<jleObject>
 jleScene::spawnObjectWithName(const std::string &name)
 {
@@ -137,3 +587,17 @@ jleScene::spawnObjectWithName(const std::string &name)
     return obj;
 }
 
+std::shared_ptr<jleObject>
+jleScene::spawnTemplateObject(const jlePath &templatePath)
+{
+    auto obj = gCore->objectTemplates().instantiate(templatePath);
+    if (!obj) {
+        return nullptr;
+    }
+
+    // Nested templates are already resolved, so there is no replaceChildrenWithTemplate() here
+    obj->propagateOwnedByScene(this);
+    _newSceneObjects.push_back(obj);
+    return obj;
+}
+
@@ -3,9 +3,14 @@
 #ifndef JLE_SCENE
 #define JLE_SCENE
 
+#include <atomic>
 #include <memory>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
+#include "jleComponentPool.h"
+#include "jleObjectHandle.h"
 #include "jleTypeReflectionUtils.h"
 #include "jlePath.h"
 #include "jleSerializedResource.h"
@@ -30,10 +35,9 @@ public:
             jlePath path{"GR:scenes/" + sceneName + getDotFileExtension()};
             filepath = path.getRealPath();
         }
-        std::ofstream save{filepath};
-        cereal::JSONOutputArchive outputArchive(save);
+        std::ofstream save{filepath, std::ios::binary};
         std::shared_ptr<jleSerializedResource> thiz = shared_from_this();
-        outputArchive(thiz);
+        jleSerialization::write(save, thiz);
     };
 
     explicit jleScene(const std::string &sceneName);
@@ -52,6 +56,9 @@ public:
     // Spawn a generic jleObject, with specified name
     std::shared_ptr<jleObject> spawnObjectWithName(const std::string& name);
 
+    // Spawn an instance of an object template (.jobj), or nullptr if it can't be loaded
+    std::shared_ptr<jleObject> spawnTemplateObject(const jlePath &templatePath);
+
     void spawnObject(std::shared_ptr<jleObject> object);
 
     void updateSceneObjects(float dt);
@@ -60,6 +67,14 @@ public:
 
     void processNewSceneObjects();
 
+    // Resolves all out of date world matrices in a single breadth-first pass,
+    // so parents are always resolved before their children without recursion
+    void resolveWorldTransforms();
+
+    // Calls onTransformChanged() on the components of objects that moved since the last call.
+    // Done once everything that may move objects this frame, including physics, has run.
+    void notifyTransformChanges();
+
     void startObjects();
 
     void saveScene();
@@ -90,18 +105,123 @@ public:
 
     std::vector<std::shared_ptr<jleObject>> &sceneObjects();
 
+    // Resolves a handle from jleObject::handle(), returns nullptr if the object is no longer in the scene
+    [[nodiscard]] jleObject *findObject(jleObjectHandle handle) const;
+
+    // Finds any object in the scene, at any depth in the hierarchy, by its instance ID
+    [[nodiscard]] jleObject *findObjectByInstanceId(uint32_t instanceId) const;
+
+    // Opt-in storage mode where the components of this scene's objects live in
+    // contiguous per-type pools and are updated type by type, instead of object by object.
+    // Should be enabled before any objects are started, for example in onSceneCreation().
+    void setComponentPoolsEnabled(bool enabled);
+
+    [[nodiscard]] bool componentPoolsEnabled() const;
+
+    template <typename T>
+    jleComponentPool &componentPool();
+
+    jleComponentPool &componentPool(std::type_index componentType);
+
+    // Opt-in recycling of destroyed objects and components, for scenes that spawn and destroy
+    // many short lived objects like projectiles. Destroyed objects that nothing else holds on to
+    // are kept per type after onDestroy(), and are reused by spawnObject(), duplicate() and
+    // addComponent(). Duplicates overwrite the reused instance with copyFrom(), spawns and added
+    // components reset it with resetForReuse(), which components have to opt in to.
+    void setObjectRecyclingEnabled(bool enabled);
+
+    [[nodiscard]] bool objectRecyclingEnabled() const;
+
     std::string sceneName;
 
 protected:
     friend class jleObject;
+    friend class jleTransform;
 
     std::vector<std::shared_ptr<jleObject>> _sceneObjects;
     std::vector<std::shared_ptr<jleObject>> _newSceneObjects;
 
+    // Set when _sceneObjects holds entries for destroyed or re-parented objects
+    bool _sceneObjectsNeedCompaction{false};
+
+    // Removes stale entries from _sceneObjects in one pass, keeping the order of the rest.
+    // Killed objects are only removed if requested, optionally running their onDestroy().
+    void compactSceneObjects(bool removePendingKill, bool propagateDestroy);
+
+    void registerObject(jleObject *object);
+
+    void unregisterObject(jleObject *object);
+
+    void unregisterObjectTree(jleObject *object);
+
+    // Makes the update loop walk the tree the object is in, from its root
+    void linkAwakeObject(jleObject *object);
+
+    void unlinkAwakeObject(jleObject *root);
+
 private:
     void startObject(jleObject *o);
 
-    static int _scenesCreatedCount;
+    void moveComponentsToPools(jleObject *o);
+
+    void updateComponentPoolsParallel(float dt);
+
+    void updateComponentPools(float dt);
+
+    // Keeps a destroyed object tree and its components for reuse, if recycling is enabled
+    void recycleObject(std::shared_ptr<jleObject> object);
+
+    // With reset, only an instance that could be reset with resetForReuse() is taken
+    std::shared_ptr<jleObject> takeRecycledObject(std::type_index objectType, bool reset = false);
+
+    std::shared_ptr<jleComponent> takeRecycledComponent(std::type_index componentType, bool reset = false);
+
+    // Copies made through a recycled instance if there is one, else through clone()
+    std::shared_ptr<jleObject> cloneObject(const jleObject &source);
+
+    std::shared_ptr<jleComponent> cloneComponent(const jleComponent &source);
+
+    struct jleObjectSlot {
+        jleObject *object{nullptr};
+        uint32_t generation{1};
+    };
+
+    std::vector<jleObjectSlot> _objectSlots;
+    std::vector<uint32_t> _freeObjectSlots;
+
+    // Kept in sync with the slot table, objects enter and leave both in register/unregisterObject
+    std::unordered_map<uint32_t, jleObject *> _objectsByInstanceId;
+
+    bool _updatingSceneObjects{false};
+
+    // Root objects with anything in their tree to update, linked through jleObject::_awakeLink.
+    // The update loop walks only these, the next one to walk is kept so that it can be unlinked.
+    jleObject *_awakeObjects{};
+    jleObject *_nextAwakeObject{};
+
+    bool _componentPoolsEnabled{false};
+
+    bool _objectRecyclingEnabled{false};
+
+    // Bounds the memory kept alive after a burst of destroyed objects
+    static constexpr std::size_t _maxRecycledPerType{256};
+
+    std::unordered_map<std::type_index, std::vector<std::shared_ptr<jleObject>>> _recycledObjects;
+    std::unordered_map<std::type_index, std::vector<std::shared_ptr<jleComponent>>> _recycledComponents;
+
+    // Set when any transform in the scene was flagged dirty since the last resolve
+    bool _dirtyTransforms{true};
+    std::vector<jleObject *> _transformResolveOrder;
+
+    // Objects whose transform was flagged dirty since the last notifyTransformChanges()
+    std::vector<jleObjectHandle> _transformChangedObjects;
+    std::vector<jleObjectHandle> _transformChangedObjectsNotifying;
+
+    // Pools in creation order for the batched update, and a lookup by component type
+    std::vector<std::unique_ptr<jleComponentPool>> _componentPools;
+    std::unordered_map<std::type_index, jleComponentPool *> _componentPoolsLookup;
+
+    static std::atomic<int> _scenesCreatedCount;
 
     void configurateSpawnedObject(const std::shared_ptr<jleObject> &obj);
 };
@@ -2,6 +2,7 @@
 
 #include "jleCore.h"
 #include "jleObject.h"
+#include "jleObjectTemplateCache.h"
 #include "jleResource.h"
 #include <fstream>
 #include <plog/Log.h>
@@ -15,23 +16,18 @@ jleScene::serialize(Archive &archive)
     for (auto &&object : _sceneObjects) {
         // Replace object with template object, if it is based on one
         if (object->__templatePath.has_value()) {
-            auto path = object->__templatePath;
-            try {
-                auto original = gCore->resources().loadResourceFromFile<jleObject>(object->__templatePath.value());
-
-                auto copy = original->duplicateTemplate();
-                object = copy;
-
-                object->__templatePath = path;
-
-            } catch (std::exception &e) {
-                LOGE << "Failed to load object template: " << e.what();
+            if (auto instance = gCore->objectTemplates().instantiate(*object->__templatePath)) {
+                object = instance;
+            } else {
+                object->replaceChildrenWithTemplate();
             }
+        } else {
+            object->replaceChildrenWithTemplate();
         }
 
-        object->replaceChildrenWithTemplate();
-
         object->propagateOwnedByScene(this);
+        object->_inSceneObjectList = true;
+        linkAwakeObject(object.get());
     }
 }
 
@@ -41,7 +37,12 @@ jleScene::spawnObject()
 {
     static_assert(std::is_base_of<jleObject, T>::value, "T must derive from jleObject");
 
-    std::shared_ptr<T> newSceneObject = std::make_shared<T>();
+    std::shared_ptr<T> newSceneObject;
+    if (auto recycled = takeRecycledObject(std::type_index{typeid(T)}, true)) {
+        newSceneObject = std::static_pointer_cast<T>(recycled);
+    } else {
+        newSceneObject = std::make_shared<T>();
+    }
     configurateSpawnedObject(newSceneObject);
 
     return newSceneObject;
@@ -56,8 +57,21 @@ jleScene::spawnObjectTypeByName(const std::string &objName)
     return newSceneObject;
 }
 
+template <typename T>
+inline jleComponentPool &
+jleScene::componentPool()
+{
+    static_assert(std::is_base_of<jleComponent, T>::value, "T must derive from jleComponent");
+    return componentPool(std::type_index{typeid(T)});
+}
+
 inline std::vector<std::shared_ptr<jleObject>> &
 jleScene::sceneObjects()
 {
+    // Drop re-parented objects before handing out the list. Killed objects are left
+    // for the update loop, since it decides whether their onDestroy() should run.
+    if (_sceneObjectsNeedCompaction && !_updatingSceneObjects) {
+        compactSceneObjects(false, false);
+    }
     return _sceneObjects;
 }
@@ -0,0 +1,100 @@
+// Copyright (c) 2023. Johan Lind
+
+#pragma once
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/cereal.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <type_traits>
+
+// Serialized resources (scenes, object templates, settings, ...) are stored either as cereal JSON,
+// which is what the editor saves so that files can be diffed, or as cereal portable binary, which
+// is much smaller and faster to parse. Binary files start with a magic header, so the format is
+// detected when loading and the file extensions stay the same for both formats.
+
+enum class jleSerializationFormat : uint8_t { Json, Binary };
+
+class jleSerialization
+{
+public:
+    static constexpr char binaryMagic[] = {'J', 'L', 'E', 'B'};
+
+    // The format resources are saved in. The editor keeps JSON, shipped builds write binary.
+    static jleSerializationFormat
+    defaultSaveFormat()
+    {
+#ifdef BUILD_EDITOR
+        return jleSerializationFormat::Json;
+#else
+        return jleSerializationFormat::Binary;
+#endif
+    }
+
+    // Peeks at the start of the stream. The binary header is consumed if present.
+    static jleSerializationFormat
+    detectFormat(std::istream &stream)
+    {
+        char header[sizeof(binaryMagic)]{};
+        const auto start = stream.tellg();
+        stream.read(header, sizeof(header));
+        if (stream.gcount() == sizeof(header) && std::equal(std::begin(header), std::end(header), binaryMagic)) {
+            return jleSerializationFormat::Binary;
+        }
+        stream.clear();
+        stream.seekg(start);
+        return jleSerializationFormat::Json;
+    }
+
+    // Reads a value written by write(), in either format. The stream should be opened in binary mode.
+    template <typename T>
+    static jleSerializationFormat
+    read(std::istream &stream, T &value)
+    {
+        const auto format = detectFormat(stream);
+        if (format == jleSerializationFormat::Binary) {
+            cereal::PortableBinaryInputArchive archive{stream};
+            archive(value);
+        } else {
+            cereal::JSONInputArchive archive{stream};
+            archive(value);
+        }
+        return format;
+    }
+
+    // Writes a value in the given format. The stream should be opened in binary mode.
+    template <typename T>
+    static void
+    write(std::ostream &stream, const T &value, jleSerializationFormat format = defaultSaveFormat())
+    {
+        if (format == jleSerializationFormat::Binary) {
+            stream.write(binaryMagic, sizeof(binaryMagic));
+            cereal::PortableBinaryOutputArchive archive{stream};
+            archive(value);
+        } else {
+            cereal::JSONOutputArchive archive{stream};
+            archive(value);
+        }
+    }
+
+    // Serializes a value that files saved before it was added don't have, those keep the default.
+    // Only JSON is read by name, binary files are converted from JSON and have all values in
+    // order, so they need to be converted again when a value is added.
+    template <class Archive, typename T>
+    static void
+    optionalNvp(Archive &archive, const char *name, T &value)
+    {
+        if constexpr (std::is_same_v<Archive, cereal::JSONInputArchive>) {
+            const char *next = archive.getNodeName();
+            if (!next || std::strcmp(next, name) != 0) {
+                return;
+            }
+        }
+        archive(cereal::make_nvp(name, value));
+    }
+};
@@ -3,16 +3,20 @@
 #pragma once
 
 #include "jleResourceInterface.h"
+#include "jleSerializationFormat.h"
 
-#define SAVE_SHARED_THIS_SERIALIZED_JSON(PTR_TYPE)                                                                     \
+// Saves as JSON in the editor and as binary in other builds, see jleSerializationFormat.h
+#define SAVE_SHARED_THIS_SERIALIZED(PTR_TYPE)                                                                          \
     void saveToFile() override                                                                                         \
     {                                                                                                                  \
-        std::ofstream save{filepath};                                                                                  \
-        cereal::JSONOutputArchive outputArchive(save);                                                                 \
+        std::ofstream save{filepath, std::ios::binary};                                                                \
         std::shared_ptr<PTR_TYPE> thiz = shared_from_this();                                                           \
-        outputArchive(thiz);                                                                                           \
+        jleSerialization::write(save, thiz);                                                                           \
     };
 
+// The name from before it also wrote binary, kept for code that still uses it
+#define SAVE_SHARED_THIS_SERIALIZED_JSON(PTR_TYPE) SAVE_SHARED_THIS_SERIALIZED(PTR_TYPE)
+
 class jleSerializedResource : public jleResourceInterface
 {
 public:
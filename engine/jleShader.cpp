@@ -1,23 +1,43 @@
 // Copyright (c) 2023. Johan Lind
 
 #include "jleShader.h"
+#include "jleCore.h"
+#include "jleResource.h"
 #include "jleStaticOpenGLState.h"
 #include "plog/Log.h"
 
 #include "jleIncludeGL.h"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <utility>
 
 // Inspired & based on examples found on learnopengl.com
 
+namespace
+{
+constexpr std::pair<const char *, jleUniformBlockBinding> uniformBlockBindings[] = {
+    {"CameraBlock", jleUniformBlockBinding::Camera},
+    {"LightsBlock", jleUniformBlockBinding::Lights},
+    {"ShadowsBlock", jleUniformBlockBinding::Shadows},
+};
+} // namespace
+
 jleShader::jleShader(const char *vertexPath, const char *fragmentPath, const char *geometryPath)
 {
     CreateFromSources(vertexPath, fragmentPath, geometryPath);
 }
 
-jleShader::~jleShader() { glDeleteProgram(ID); }
+jleShader::~jleShader()
+{
+#ifndef BUILD_HEADLESS
+    glDeleteProgram(ID);
+#endif
+}
 
 void
 jleShader::use()
@@ -28,73 +48,231 @@ jleShader::use()
 void
 jleShader::SetBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setUniform(uniformIndex(name), value);
 }
 
 void
 jleShader::SetInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    setUniform(uniformIndex(name), value);
 }
 
 void
 jleShader::SetFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    setUniform(uniformIndex(name), value);
 }
 
 void
 jleShader::SetVec2(const std::string &name, const glm::vec2 &value) const
 {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    setUniform(uniformIndex(name), value);
 }
 
 void
 jleShader::SetVec2(const std::string &name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    setUniform(uniformIndex(name), glm::vec2{x, y});
 }
 
 void
 jleShader::SetVec3(const std::string &name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    setUniform(uniformIndex(name), value);
 }
 
 void
 jleShader::SetVec3(const std::string &name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    setUniform(uniformIndex(name), glm::vec3{x, y, z});
 }
 
 void
 jleShader::SetVec4(const std::string &name, const glm::vec4 &value) const
 {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    setUniform(uniformIndex(name), value);
 }
 
 void
 jleShader::SetVec4(const std::string &name, float x, float y, float z, float w)
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    setUniform(uniformIndex(name), glm::vec4{x, y, z, w});
 }
 
 void
 jleShader::SetMat2(const std::string &name, const glm::mat2 &mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setUniform(uniformIndex(name), mat);
 }
 
 void
 jleShader::SetMat3(const std::string &name, const glm::mat3 &mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setUniform(uniformIndex(name), mat);
 }
 
 void
 jleShader::SetMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setUniform(uniformIndex(name), mat);
+}
+
+uint32_t
+jleShader::uniformIndex(const std::string &name) const
+{
+    auto it = _uniformIndices.find(name);
+    if (it != _uniformIndices.end()) {
+        return it->second;
+    }
+
+    const auto index = static_cast<uint32_t>(_uniforms.size());
+    auto &slot = _uniforms.emplace_back();
+    if (ID) {
+        slot.location = glGetUniformLocation(ID, name.c_str());
+    }
+    _uniformIndices.emplace(name, index);
+    return index;
+}
+
+int
+jleShader::changedLocation(uint32_t index, const void *value, std::size_t size) const
+{
+    auto &slot = _uniforms[index];
+    if (slot.location < 0) {
+        return -1;
+    }
+    if (slot.hasValue && std::memcmp(slot.value.data(), value, size) == 0) {
+        return -1;
+    }
+    std::memcpy(slot.value.data(), value, size);
+    slot.hasValue = true;
+    return slot.location;
+}
+
+void
+jleShader::setUniform(uint32_t index, bool value) const
+{
+    setUniform(index, static_cast<int>(value));
+}
+
+void
+jleShader::setUniform(uint32_t index, int value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniform1i(location, value);
+    }
+}
+
+void
+jleShader::setUniform(uint32_t index, float value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniform1f(location, value);
+    }
+}
+
+void
+jleShader::setUniform(uint32_t index, const glm::vec2 &value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniform2fv(location, 1, &value[0]);
+    }
+}
+
+void
+jleShader::setUniform(uint32_t index, const glm::vec3 &value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniform3fv(location, 1, &value[0]);
+    }
+}
+
+void
+jleShader::setUniform(uint32_t index, const glm::vec4 &value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniform4fv(location, 1, &value[0]);
+    }
+}
+
+void
+jleShader::setUniform(uint32_t index, const glm::mat2 &value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniformMatrix2fv(location, 1, GL_FALSE, &value[0][0]);
+    }
+}
+
+void
+jleShader::setUniform(uint32_t index, const glm::mat3 &value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]);
+    }
+}
+
+void
+jleShader::setUniform(uint32_t index, const glm::mat4 &value) const
+{
+    const auto location = changedLocation(index, &value, sizeof(value));
+    if (location >= 0) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+    }
+}
+
+void
+jleShader::reflectUniforms()
+{
+    // The new program starts out with default values, and may have moved or dropped uniforms
+    for (auto &&slot : _uniforms) {
+        slot.hasValue = false;
+    }
+    for (auto &&[name, index] : _uniformIndices) {
+        _uniforms[index].location = glGetUniformLocation(ID, name.c_str());
+    }
+
+    GLint count = 0, maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type;
+        glGetActiveUniform(ID, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+        std::string name{nameBuffer.data(), (std::size_t)length};
+
+        // Arrays are reported by their first element, each element gets its own entry
+        const std::string arraySuffix = "[0]";
+        if (name.size() > arraySuffix.size() &&
+            name.compare(name.size() - arraySuffix.size(), arraySuffix.size(), arraySuffix) == 0) {
+            const auto arrayName = name.substr(0, name.size() - arraySuffix.size());
+            for (GLint element = 0; element < size; element++) {
+                (void)uniformIndex(arrayName + '[' + std::to_string(element) + ']');
+            }
+        } else {
+            (void)uniformIndex(name);
+        }
+    }
+}
+
+void
+jleShader::bindUniformBlocks()
+{
+    for (auto &&[name, binding] : uniformBlockBindings) {
+        const auto blockIndex = glGetUniformBlockIndex(ID, name);
+        if (blockIndex != GL_INVALID_INDEX) {
+            glUniformBlockBinding(ID, blockIndex, static_cast<GLuint>(binding));
+        }
+    }
 }
 
 void
@@ -126,6 +304,23 @@ jleShader::checkCompileErrors(unsigned int shader, std::string type)
 void
 jleShader::CreateFromSources(const char *vertexPath, const char *fragmentPath, const char *geometryPath)
 {
+    // Shaders are never used without a rendering context
+#ifndef BUILD_HEADLESS
+    if (!gCore->resources().isMainThread()) {
+        // Deserialized as part of a scene loading on a background thread, compile on the main thread
+        std::string vertex{vertexPath}, fragment{fragmentPath};
+        std::optional<std::string> geometry;
+        if (geometryPath) {
+            geometry = geometryPath;
+        }
+        gCore->resources().runOnMainThread([weakSelf = weak_from_this(), vertex, fragment, geometry]() {
+            if (auto self = weakSelf.lock()) {
+                self->CreateFromSources(vertex.c_str(), fragment.c_str(), geometry ? geometry->c_str() : nullptr);
+            }
+        });
+        return;
+    }
+
     assert(jleStaticOpenGLState::globalOpenGLInitialized == true);
 
     LOG_VERBOSE << "Compiling shader: " << vertexPath << " , " << fragmentPath;
@@ -197,6 +392,7 @@ jleShader::CreateFromSources(const char *vertexPath, const char *fragmentPath, c
     // 	checkCompileErrors(geometry, "GEOMETRY");
     // }
     // shader Program
+    const auto previousProgram = ID;
     ID = glCreateProgram();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
@@ -211,7 +407,15 @@ jleShader::CreateFromSources(const char *vertexPath, const char *fragmentPath, c
     // if (geometryPath != nullptr)
     // 	glDeleteShader(geometry);
 
+    // Recompiled, for example when the shader is hot reloaded
+    if (previousProgram) {
+        glDeleteProgram(previousProgram);
+    }
+    reflectUniforms();
+    bindUniformBlocks();
+
     LOG_VERBOSE << "Compiled shader, ID: " << ID;
+#endif
 }
 std::vector<std::string>
 jleShader::getFileAssociationList()
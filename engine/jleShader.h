@@ -10,12 +10,21 @@
 
 #include <glm/glm.hpp>
 
+#include <array>
+#include <cstddef>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// Binding points of the uniform blocks shared between shaders, see jle3DRenderer. GLSL ES 3.00 has no
+// binding layout qualifier, so blocks named CameraBlock, LightsBlock and ShadowsBlock are bound to
+// their point when a shader is linked, and buffers bound to a point once are seen by all shaders.
+enum class jleUniformBlockBinding : uint32_t { Camera = 0, Lights = 1, Shadows = 2 };
 
 class jleShader : public jleSerializedResource, public std::enable_shared_from_this<jleShader>
 {
 public:
-    unsigned int ID;
+    unsigned int ID{};
 
     JLE_REGISTER_RESOURCE_TYPE(jleShader, sh)
 
@@ -48,7 +57,7 @@ public:
 
     std::vector<std::string> getFileAssociationList() override;
 
-    SAVE_SHARED_THIS_SERIALIZED_JSON(jleSerializedResource)
+    SAVE_SHARED_THIS_SERIALIZED(jleSerializedResource)
 
     jleShader() = default;
 
@@ -83,15 +92,83 @@ public:
 
     void SetMat4(const std::string &name, const glm::mat4 &mat) const;
 
+    // Index of the uniform in this shader's uniform table. It stays the same when the shader is
+    // recompiled, so it can be kept by callers, see jleShaderUniform. Uniforms that aren't active
+    // in the program get an index as well, setting them does nothing.
+    [[nodiscard]] uint32_t uniformIndex(const std::string &name) const;
+
+    // Sets the uniform in the program, which must be in use, unless it already has the value
+    void setUniform(uint32_t index, bool value) const;
+
+    void setUniform(uint32_t index, int value) const;
+
+    void setUniform(uint32_t index, float value) const;
+
+    void setUniform(uint32_t index, const glm::vec2 &value) const;
+
+    void setUniform(uint32_t index, const glm::vec3 &value) const;
+
+    void setUniform(uint32_t index, const glm::vec4 &value) const;
+
+    void setUniform(uint32_t index, const glm::mat2 &value) const;
+
+    void setUniform(uint32_t index, const glm::mat3 &value) const;
+
+    void setUniform(uint32_t index, const glm::mat4 &value) const;
+
 private:
     void CreateFromSources(const char *vertexPath, const char *fragmentPath, const char *geometryPath = nullptr);
 
+    // Fills the uniform table from the active uniforms of the linked program, and looks up
+    // the locations of uniforms already in the table again
+    void reflectUniforms();
+
+    void bindUniformBlocks();
+
+    // Location to upload the value to, or -1 if the uniform already has the value
+    int changedLocation(uint32_t index, const void *value, std::size_t size) const;
+
+    struct jleShaderUniformSlot {
+        int location{-1};
+        bool hasValue{false};
+
+        // Last uploaded value, large enough for a mat4
+        std::array<std::byte, sizeof(glm::mat4)> value{};
+    };
+
+    // Filled lazily by the setters, so mutable for the const setters
+    mutable std::vector<jleShaderUniformSlot> _uniforms;
+    mutable std::unordered_map<std::string, uint32_t> _uniformIndices;
+
     void checkCompileErrors(unsigned int shader, std::string type);
 
     jlePath _vertexPath;
     jlePath _fragPath;
 };
 
+// Uniform looked up once and kept by the caller, so that setting it takes no lookup by name
+template <typename T>
+class jleShaderUniform
+{
+public:
+    jleShaderUniform() = default;
+
+    jleShaderUniform(const jleShader &shader, const std::string &name)
+        : _shader{&shader}, _index{shader.uniformIndex(name)}
+    {
+    }
+
+    void
+    set(const T &value) const
+    {
+        _shader->setUniform(_index, value);
+    }
+
+private:
+    const jleShader *_shader{};
+    uint32_t _index{};
+};
+
 CEREAL_REGISTER_TYPE(jleShader)
 CEREAL_REGISTER_POLYMORPHIC_RELATION(jleSerializedResource, jleShader)
 
@@ -11,6 +11,7 @@
 jleLoadFromFileSuccessCode
 jleSkybox::loadFromFile(const jlePath &path)
 {
+#ifndef BUILD_HEADLESS
     constexpr float skyboxVertices[] = {// positions
                                         -1.0f, 1.0f,  -1.0f, -1.0f, -1.0f, -1.0f, 1.0f,  -1.0f, -1.0f,
                                         1.0f,  -1.0f, -1.0f, 1.0f,  1.0f,  -1.0f, -1.0f, 1.0f,  -1.0f,
@@ -71,6 +72,7 @@ jleSkybox::loadFromFile(const jlePath &path)
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+#endif
 
     return jleLoadFromFileSuccessCode::SUCCESS;
 }
@@ -15,7 +15,7 @@ class jleSkybox : public jleSerializedResource, public std::enable_shared_from_t
 public:
     JLE_REGISTER_RESOURCE_TYPE(jleSkybox, skyb)
 
-    SAVE_SHARED_THIS_SERIALIZED_JSON(jleSerializedResource)
+    SAVE_SHARED_THIS_SERIALIZED(jleSerializedResource)
 
     template <class Archive>
     void
@@ -35,6 +35,12 @@ public:
 
     jleLoadFromFileSuccessCode loadFromFile(const jlePath &path) override;
 
+    [[nodiscard]] bool
+    requiresMainThreadLoad() const override
+    {
+        return true;
+    }
+
     jleResourceRef<jleImageFlipped> _right;
     jleResourceRef<jleImageFlipped> _left;
     jleResourceRef<jleImageFlipped> _bottom;
@@ -38,6 +38,8 @@ jleTexture::loadFromFile(const jlePath &path)
     _height = image.height();
     _nrChannels = image.nrChannels();
 
+    // Only the dimensions are kept when there is no rendering context
+#ifndef BUILD_HEADLESS
     glGenTextures(1, &_id);
 
     glBindTexture(GL_TEXTURE_2D, _id);
@@ -84,6 +86,7 @@ jleTexture::loadFromFile(const jlePath &path)
 
         return jleLoadFromFileSuccessCode::FAIL;
     }
+#endif
 
     return jleLoadFromFileSuccessCode::SUCCESS;
 }
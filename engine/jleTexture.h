@@ -26,7 +26,13 @@ public:
 
     jleLoadFromFileSuccessCode loadFromFile(const jlePath &path) override;
 
-    SAVE_SHARED_THIS_SERIALIZED_JSON(jleSerializedResource)
+    [[nodiscard]] bool
+    requiresMainThreadLoad() const override
+    {
+        return true;
+    }
+
+    SAVE_SHARED_THIS_SERIALIZED(jleSerializedResource)
 
     std::vector<std::string> getFileAssociationList() override;
 
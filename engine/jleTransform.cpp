@@ -2,6 +2,13 @@
 
 #include "jleTransform.h"
 #include "jleObject.h"
+#include "jleScene.h"
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#endif
 
 JLE_EXTERN_TEMPLATE_CEREAL_CPP(jleTransform)
 
@@ -16,6 +23,37 @@ jleTransform::serialize(Archive &arcc)
     arcc(CEREAL_NVP(_local));
 }
 
+namespace
+{
+// out = a * b for column-major 4x4 matrices
+inline void
+multiplyMatrix(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &out)
+{
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    const float *pa = &a[0][0];
+    const float *pb = &b[0][0];
+    float *po = &out[0][0];
+
+    const __m128 a0 = _mm_loadu_ps(pa + 0);
+    const __m128 a1 = _mm_loadu_ps(pa + 4);
+    const __m128 a2 = _mm_loadu_ps(pa + 8);
+    const __m128 a3 = _mm_loadu_ps(pa + 12);
+
+    // Each column of the result is a linear combination of the columns of a
+    for (int column = 0; column < 4; column++) {
+        const float *bc = pb + column * 4;
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_storeu_ps(po + column * 4, r);
+    }
+#else
+    out = a * b;
+#endif
+}
+} // namespace
+
 void
 jleTransform::setWorldPosition(const glm::vec3 &position)
 {
@@ -31,21 +69,19 @@ jleTransform::setWorldPosition(const glm::vec3 &position)
     _local[3][1] = newPos.y;
     _local[3][2] = newPos.z;
 
-    propagateMatrix();
+    markChanged();
 }
 void
 jleTransform::setWorldMatrix(const glm::mat4 &matrix)
 {
-
     if (auto p = _owner->parent()) {
-        const auto &parentWorld = p->getTransform().getWorldMatrix();
-        _local = glm::inverse(parentWorld) * matrix;
-        propagateMatrix();
+        multiplyMatrix(p->getTransform().getInverseWorldMatrix(), matrix, _local);
+        markChanged();
         return;
     }
 
     _local = matrix;
-    propagateMatrix();
+    markChanged();
 }
 void
 jleTransform::setLocalPosition(const glm::vec3 &position)
@@ -54,7 +90,7 @@ jleTransform::setLocalPosition(const glm::vec3 &position)
     _local[3][1] = position.y;
     _local[3][2] = position.z;
 
-    propagateMatrix();
+    markChanged();
 }
 void
 jleTransform::addLocalTranslation(const glm::vec3& position)
@@ -63,7 +99,7 @@ jleTransform::addLocalTranslation(const glm::vec3& position)
     _local[3][1] += position.y;
     _local[3][2] += position.z;
 
-    propagateMatrix();
+    markChanged();
 }
 glm::vec3
 jleTransform::getLocalPosition()
@@ -73,14 +109,29 @@ jleTransform::getLocalPosition()
 glm::vec3
 jleTransform::getWorldPosition()
 {
-    return glm::vec3{_world[3]};
+    return glm::vec3{getWorldMatrix()[3]};
 }
 const glm::mat4 &
 jleTransform::getWorldMatrix()
 {
+    if (_dirty) {
+        multiplyMatrix(getParentWorld(), _local, _world);
+        _dirty = false;
+    }
     return _world;
 }
 
+const glm::mat4 &
+jleTransform::getInverseWorldMatrix()
+{
+    if (_inverseDirty) {
+        // Transforms only hold translation, rotation and scale
+        _inverseWorld = glm::affineInverse(getWorldMatrix());
+        _inverseDirty = false;
+    }
+    return _inverseWorld;
+}
+
 [[nodiscard]] const glm::mat4 &
 jleTransform::getLocalMatrix()
 {
@@ -91,27 +142,61 @@ const glm::mat4 &
 jleTransform::getParentWorld()
 {
     if (auto p = _owner->parent()) {
-        return p->getTransform()._world;
+        return p->getTransform().getWorldMatrix();
     }
     static const glm::mat4 identityReturn{1.f};
     return identityReturn;
 }
 
 void
-jleTransform::propagateMatrix()
+jleTransform::flagDirty()
 {
-    _world = getParentWorld() * getLocalMatrix();
+    if (_dirty) {
+        return;
+    }
+
+    _dirty = true;
+    _inverseDirty = true;
 
-    auto &children = _owner->childObjects();
-    for (auto &&child : children) {
-        child->getTransform().propagateMatrix();
+    if (auto scene = _owner->_containedInScene) {
+        scene->_dirtyTransforms = true;
+        if (_owner->_handle.valid()) {
+            scene->_transformChangedObjects.push_back(_owner->_handle);
+        }
     }
+
+    for (auto &&child : _owner->childObjects()) {
+        child->getTransform().flagDirty();
+    }
+}
+
+void
+jleTransform::markChanged()
+{
+    flagDirty();
+    _owner->wake();
+}
+
+void
+jleTransform::resolveFromResolvedParent()
+{
+    if (!_dirty) {
+        return;
+    }
+
+    if (auto p = _owner->parent()) {
+        multiplyMatrix(p->getTransform()._world, _local, _world);
+    } else {
+        _world = _local;
+    }
+    _dirty = false;
 }
+
 void
 jleTransform::setLocalMatrix(const glm::mat4 &matrix)
 {
     _local = matrix;
-    propagateMatrix();
+    markChanged();
 }
 
 glm::vec3
@@ -39,20 +39,37 @@ public:
 
     [[nodiscard]] glm::vec3 getWorldPosition();
 
+    // Resolves the world matrix, and any dirty parents, if it is out of date
     [[nodiscard]] const glm::mat4 &getWorldMatrix();
 
+    [[nodiscard]] const glm::mat4 &getInverseWorldMatrix();
+
     [[nodiscard]] const glm::mat4 &getLocalMatrix();
 
 private:
     friend class jleObject;
+    friend class jleScene;
+
     const glm::mat4 &getParentWorld();
 
-    void propagateMatrix();
+    // Marks this transform and all of its descendants as needing their world matrix resolved.
+    // A dirty transform always has dirty descendants, so the walk stops at already dirty nodes.
+    void flagDirty();
+
+    // Called by the setters, also wakes the owner up if it sleeps
+    void markChanged();
+
+    // Resolves assuming the parent is already up to date, used for the flattened per-frame update
+    void resolveFromResolvedParent();
 
     jleObject *_owner;
 
     glm::mat4 _local{1.f};
     glm::mat4 _world{1.f};
+    glm::mat4 _inverseWorld{1.f};
+
+    bool _dirty{true};
+    bool _inverseDirty{true};
 };
 
 JLE_EXTERN_TEMPLATE_CEREAL_H(jleTransform)
@@ -3,10 +3,14 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <typeinfo>
+#include <vector>
 
 #include <iostream>
 
@@ -17,15 +21,31 @@
 public:                                                                                                                \
     virtual std::string_view objectNameVirtual() { return #object_name; }                                              \
     virtual std::shared_ptr<jleObject> clone() const { return std::make_shared<object_name>(*this); }                  \
+    virtual void copyFrom(const jleObject &other) { *this = static_cast<const object_name &>(other); }                 \
+    virtual bool resetForReuse()                                                                                       \
+    {                                                                                                                  \
+        if (typeid(*this) != typeid(object_name)) {                                                                    \
+            return false;                                                                                              \
+        }                                                                                                              \
+        *this = object_name{};                                                                                         \
+        resetObjectForReuse();                                                                                         \
+        return true;                                                                                                   \
+    }                                                                                                                  \
                                                                                                                        \
 private:
 
 #define JLE_REGISTER_COMPONENT_TYPE(component_name)                                                                    \
     const std::string_view componentName() const override { return #component_name; }                                  \
+    uint32_t componentTypeId() const override { return jleTypeReflectionUtils::componentTypeId<component_name>(); }    \
     static inline const jleComponentTypeRegistrator<component_name> component_name_Reg{#component_name};               \
                                                                                                                        \
 public:                                                                                                                \
     std::shared_ptr<jleComponent> clone() const override { return std::make_shared<component_name>(*this); }           \
+    void copyFrom(const jleComponent &other) override { *this = static_cast<const component_name &>(other); }          \
+    std::shared_ptr<jleComponent> clonePooled(jleComponentPool &pool) const override                                   \
+    {                                                                                                                  \
+        return pool.create<component_name>(*this);                                                                     \
+    }                                                                                                                  \
     void registerSelfLua(sol::table &self) override { self[componentName()] = this; }                                  \
                                                                                                                        \
 private:
@@ -44,6 +64,8 @@ class jleObject;
 
 class jleComponent;
 
+class jleComponentPool;
+
 class jleResourceInterface;
 
 class jleTypeReflectionUtils
@@ -70,7 +92,28 @@ public:
 
     static std::map<std::string, jleRegisteredResourceInterfaceData> &registeredResourcesRef();
 
+    // Dense ID of a component type, assigned the first time it is requested.
+    // Types registered with JLE_REGISTER_COMPONENT_TYPE get theirs during static initialization.
+    template <typename T>
+    static uint32_t componentTypeId();
+
+    static uint32_t componentTypeCount();
+
+    // IDs of all component types that a component of type typeId is an instance of, including its own.
+    // Worked out with dynamic_cast the first time, and cached per type after that.
+    // Returned by value since scenes loading on other threads may extend the cache.
+    static std::vector<uint32_t> componentTypeIdsOf(uint32_t typeId, const jleComponent *component);
+
 private:
+    using jleComponentTypeCheck = bool (*)(const jleComponent *);
+
+    static uint32_t registerComponentTypeId(jleComponentTypeCheck isInstance);
+
+    struct jleComponentTypeAncestry {
+        std::vector<uint32_t> typeIds;
+        uint32_t checkedTypeCount{0};
+    };
+
     // Should always be accessed via registeredObjectsRef()
     static inline std::unique_ptr<std::map<std::string, std::function<std::shared_ptr<jleObject>()>>>
         _registeredObjectsPtr{nullptr};
@@ -82,6 +125,16 @@ private:
     // Should always be accessed via registeredResourcesRef()
     static inline std::unique_ptr<std::map<std::string, jleRegisteredResourceInterfaceData>> _registeredResourcesPtr{
         nullptr};
+
+    // Indexed by component type ID, should always be accessed via componentTypeChecksRef()
+    static inline std::unique_ptr<std::vector<jleComponentTypeCheck>> _componentTypeChecksPtr{nullptr};
+
+    static inline std::vector<jleComponentTypeAncestry> _componentTypeAncestries{};
+
+    static std::vector<jleComponentTypeCheck> &componentTypeChecksRef();
+
+    // Guards the component type IDs and their cached ancestries
+    static std::mutex &componentTypeMutex();
 };
 
 template <typename T>
@@ -73,6 +73,68 @@ jleTypeReflectionUtils::registeredResourcesRef()
     return *_registeredResourcesPtr;
 }
 
+template <typename T>
+inline uint32_t
+jleTypeReflectionUtils::componentTypeId()
+{
+    static_assert(std::is_base_of<jleComponent, T>::value, "T must derive from jleComponent");
+
+    static const uint32_t id = registerComponentTypeId(
+        [](const jleComponent *c) { return dynamic_cast<const T *>(c) != nullptr; });
+    return id;
+}
+
+inline uint32_t
+jleTypeReflectionUtils::componentTypeCount()
+{
+    std::lock_guard lock{componentTypeMutex()};
+    return static_cast<uint32_t>(componentTypeChecksRef().size());
+}
+
+inline std::vector<uint32_t>
+jleTypeReflectionUtils::componentTypeIdsOf(uint32_t typeId, const jleComponent *component)
+{
+    std::lock_guard lock{componentTypeMutex()};
+    if (_componentTypeAncestries.size() <= typeId) {
+        _componentTypeAncestries.resize(typeId + 1);
+    }
+
+    // Types can get their ID after the cache was built, for example bases that are not registered
+    auto &ancestry = _componentTypeAncestries[typeId];
+    const auto &checks = componentTypeChecksRef();
+    for (; ancestry.checkedTypeCount < checks.size(); ancestry.checkedTypeCount++) {
+        if (checks[ancestry.checkedTypeCount](component)) {
+            ancestry.typeIds.push_back(ancestry.checkedTypeCount);
+        }
+    }
+    return ancestry.typeIds;
+}
+
+inline uint32_t
+jleTypeReflectionUtils::registerComponentTypeId(jleComponentTypeCheck isInstance)
+{
+    std::lock_guard lock{componentTypeMutex()};
+    auto &checks = componentTypeChecksRef();
+    checks.push_back(isInstance);
+    return static_cast<uint32_t>(checks.size() - 1);
+}
+
+inline std::vector<jleTypeReflectionUtils::jleComponentTypeCheck> &
+jleTypeReflectionUtils::componentTypeChecksRef()
+{
+    if (!_componentTypeChecksPtr) {
+        _componentTypeChecksPtr = std::make_unique<std::vector<jleComponentTypeCheck>>();
+    }
+    return *_componentTypeChecksPtr;
+}
+
+inline std::mutex &
+jleTypeReflectionUtils::componentTypeMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
 template <typename T>
 inline jleObjectTypeRegistrator<T>::jleObjectTypeRegistrator(const std::string &oName)
 {
@@ -92,6 +154,8 @@ inline jleComponentTypeRegistrator<T>::jleComponentTypeRegistrator(const std::st
 #endif
     std::function<std::shared_ptr<T>()> cCreationFunc = []() { return std::make_shared<T>(); };
 
+    jleTypeReflectionUtils::componentTypeId<T>();
+
     jleTypeReflectionUtils::registeredComponentsRef().insert(std::make_pair(cName, cCreationFunc));
 }
 
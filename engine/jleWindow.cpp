@@ -93,8 +93,10 @@ jleWindow::scrollY()
 
 jleWindow::~jleWindow()
 {
-    glfwDestroyWindow(_glfwWindow);
-    glfwTerminate();
+    if (_glfwWindow) {
+        glfwDestroyWindow(_glfwWindow);
+        glfwTerminate();
+    }
 }
 
 void
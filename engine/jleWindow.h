@@ -73,7 +73,7 @@ public:
     }
 
 protected:
-    GLFWwindow *_glfwWindow;
+    GLFWwindow *_glfwWindow{nullptr};
 
     WindowSettings windowSettings;
 
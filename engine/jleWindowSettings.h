@@ -4,6 +4,7 @@
 
 #include "jlePathDefines.h"
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 
 #include <string>
 
@@ -22,6 +22,7 @@
 
 #include <cereal/cereal.hpp>
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 #include "cereal/details/helpers.hpp"
 #include "cereal/types/memory.hpp"
 #include "cereal/types/polymorphic.hpp"
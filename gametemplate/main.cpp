@@ -3,8 +3,8 @@
 #include "jleKickStarter.h"
 
 int
-main()
+main(int argc, char *argv[])
 {
-    kickStart<GameTemplate>();
+    kickStart<GameTemplate>(argc, argv);
     return 0;
 }
\ No newline at end of file